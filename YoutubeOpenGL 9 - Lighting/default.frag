@@ -1,7 +1,9 @@
 #version 330 core
 
-// Outputs colors in RGBA
-out vec4 FragColor;
+// Outputs colors in RGBA (translucent: weighted color and alpha, see OitPass)
+layout (location = 0) out vec4 FragColor;
+// Translucent only: alpha * weight, into OitPass's second target
+layout (location = 1) out vec4 OitWeight;
 
 
 // Imports the color from the Vertex Shader
@@ -21,6 +23,72 @@ uniform vec4 lightColor;
 uniform vec3 lightPos;
 // Gets the position of the camera from the main function
 uniform vec3 camPos;
+// Below 1 the surface is translucent and written for the weighted blended OIT pass
+uniform float opacity = 1.0f;
+// Gets the light's view-projection matrix from the main function
+uniform mat4 lightMatrix;
+// Depth of the static casters (cached) and of the moving ones (every frame), seen from the light
+uniform sampler2DShadow shadowStatic;
+uniform sampler2DShadow shadowDynamic;
+
+// 1 where the light reaches this fragment, 0 in shadow (3x3 PCF over both shadow maps)
+float shadowFactor(vec3 normal, vec3 lightDirection)
+{
+	vec4 lightClip = lightMatrix * vec4(crntPos, 1.0f);
+	// behind the light or past its far plane counts as lit
+	if (lightClip.w <= 0.0f) return 1.0f;
+	vec3 coord = lightClip.xyz / lightClip.w * 0.5f + 0.5f;
+	if (coord.z > 1.0f) return 1.0f;
+
+	// a little more bias on surfaces at grazing angles to the light
+	coord.z -= max(0.0002f * (1.0f - dot(normal, lightDirection)), 0.00005f);
+	vec2 texel = 1.0f / vec2(textureSize(shadowStatic, 0));
+	float lit = 0.0f;
+	for (int x = -1; x <= 1; ++x)
+		for (int y = -1; y <= 1; ++y)
+		{
+			vec3 tap = vec3(coord.xy + vec2(x, y) * texel, coord.z);
+			lit += min(texture(shadowStatic, tap), texture(shadowDynamic, tap));
+		}
+	return lit / 9.0f;
+}
+
+// Point lights, binned per view-space cluster on the CPU (ClusteredLights)
+uniform samplerBuffer pointLights;     // 2 texels per light: position + radius, color
+uniform usamplerBuffer lightClusters;  // per cluster: first entry in lightIndices, light count
+uniform usamplerBuffer lightIndices;
+uniform mat4 view;                     // world -> view space, for the fragment's depth
+uniform ivec3 clusterCount;            // tiles across, tiles up, depth slices
+uniform vec2 clusterTileScale;         // tiles per pixel
+uniform vec2 clusterDepthScale;        // slice = log(depth) * x + y
+
+// diffuse + specular from the point lights of this fragment's cluster only
+vec3 pointLighting(vec3 normal, vec3 viewDirection)
+{
+	float depth = -(view * vec4(crntPos, 1.0f)).z;
+	ivec3 cell = ivec3(ivec2(gl_FragCoord.xy * clusterTileScale), int(log(depth) * clusterDepthScale.x + clusterDepthScale.y));
+	cell = clamp(cell, ivec3(0), clusterCount - 1);
+	uvec2 range = texelFetch(lightClusters, (cell.z * clusterCount.y + cell.y) * clusterCount.x + cell.x).rg;
+
+	vec3 total = vec3(0.0f);
+	for (uint i = 0u; i < range.y; ++i)
+	{
+		int light = int(texelFetch(lightIndices, int(range.x + i)).r);
+		vec4 positionRadius = texelFetch(pointLights, 2 * light);
+		vec3 pointColor = texelFetch(pointLights, 2 * light + 1).rgb;
+
+		vec3 toLight = positionRadius.xyz - crntPos;
+		float dist = length(toLight);
+		// falls smoothly to zero at the light's radius
+		float falloff = clamp(1.0f - dist / positionRadius.w, 0.0f, 1.0f);
+		falloff *= falloff;
+		vec3 direction = toLight / max(dist, 0.0001f);
+		float diffuse = max(dot(normal, direction), 0.0f);
+		float specular = pow(max(dot(viewDirection, reflect(-direction, normal)), 0.0f), 8) * 0.50f;
+		total += pointColor * falloff * (diffuse + specular);
+	}
+	return total;
+}
 
 void main()
 {
@@ -39,6 +107,25 @@ void main()
 	float specAmount = pow(max(dot(viewDirection, reflectionDirection), 0.0f), 8);
 	float specular = specAmount * specularLight;
 
-	// outputs final color
-	FragColor = texture(tex0, texCoord) * lightColor * (diffuse + ambient + specular);
+	// shadows take away the diffuse and specular light, not the ambient
+	float shadow = shadowFactor(normal, lightDirection);
+
+	// the main light, plus whatever point lights reach this fragment
+	vec4 light = lightColor * (ambient + shadow * (diffuse + specular));
+	light.rgb += pointLighting(normal, viewDirection);
+
+	vec4 surface = texture(tex0, texCoord) * light;
+	if (opacity >= 1.0f)
+	{
+		// outputs final color
+		FragColor = surface;
+		return;
+	}
+
+	// translucent: weighted by coverage and nearness (McGuire & Bavoil, eq. 10), so the
+	// nearest layers dominate whatever order they are drawn in
+	float alpha = opacity * surface.a;
+	float weight = clamp(alpha * max(0.01f, 3000.0f * pow(1.0f - gl_FragCoord.z, 3.0f)), 0.01f, 3000.0f);
+	FragColor = vec4(surface.rgb * alpha * weight, alpha);
+	OitWeight = vec4(alpha * weight);
 }
\ No newline at end of file
@@ -0,0 +1,52 @@
+#version 330 core
+
+// Particle this vertex sits on (vertices on shared edges and corners point at the same one)
+layout (location = 0) in int aParticle;
+// Colors
+layout (location = 1) in vec3 aColor;
+// Texture Coordinates
+layout (location = 2) in vec2 aTex;
+// Normals (not necessarily normalized)
+layout (location = 3) in vec3 aNormal;
+// This jelly's first particle in the position buffer (aParticle counts from it)
+layout (location = 4) in int aParticleBase;
+
+
+// Outputs the color for the Fragment Shader
+out vec3 color;
+// Outputs the texture coordinates to the Fragment Shader
+out vec2 texCoord;
+// Outputs the normal for the Fragment Shader
+out vec3 Normal;
+// Outputs the current position for the Fragment Shader
+out vec3 crntPos;
+
+// Particle positions: one GL_RGB32F texel each, or a flat x, y, z stream of GL_R32F texels
+uniform samplerBuffer positions;
+uniform int positionTexels = 3;
+// Imports the camera matrix from the main function
+uniform mat4 camMatrix;
+// Imports the model matrix from the main function
+uniform mat4 model;
+
+
+void main()
+{
+	// fetches this vertex's particle position
+	int particle = aParticleBase + aParticle;
+	int base = 3 * particle;
+	vec3 aPos = positionTexels == 1 ? texelFetch(positions, particle).rgb
+		: vec3(texelFetch(positions, base).r, texelFetch(positions, base + 1).r, texelFetch(positions, base + 2).r);
+
+	// calculates current position
+	crntPos = vec3(model * vec4(aPos, 1.0f));
+	// Outputs the positions/coordinates of all vertices
+	gl_Position = camMatrix * vec4(crntPos, 1.0);
+
+	// Assigns the colors from the Vertex Data to "color"
+	color = aColor;
+	// Assigns the texture coordinates from the Vertex Data to "texCoord"
+	texCoord = aTex;
+	// Assigns the normal from the Vertex Data to "Normal"
+	Normal = aNormal;
+}
\ No newline at end of file
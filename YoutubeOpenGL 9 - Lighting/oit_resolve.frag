@@ -0,0 +1,23 @@
+#version 330 core
+
+// Outputs the translucent layer, blended over the opaque image by its coverage
+out vec4 FragColor;
+
+// Weighted color sums (rgb) and revealage (a) from the translucent pass
+uniform sampler2D accumTex;
+// Weight sums from the translucent pass
+uniform sampler2D weightTex;
+
+void main()
+{
+	ivec2 pixel = ivec2(gl_FragCoord.xy);
+	vec4 accum = texelFetch(accumTex, pixel, 0);
+	float revealage = accum.a;
+	// nothing translucent here
+	if (revealage >= 0.9999f) discard;
+
+	float weight = texelFetch(weightTex, pixel, 0).r;
+	// weighted average color, clamped so a huge sum in half floats cannot blow it up
+	vec3 average = accum.rgb / clamp(weight, 0.0001f, 50000.0f);
+	FragColor = vec4(average, 1.0f - revealage);
+}
\ No newline at end of file
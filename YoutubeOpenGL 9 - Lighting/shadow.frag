@@ -0,0 +1,7 @@
+#version 330 core
+
+// Depth-only pass for the shadow maps: the vertex shader (default.vert or jelly.vert, with
+// camMatrix set to the light matrix) places the geometry and only depth is written
+void main()
+{
+}
\ No newline at end of file
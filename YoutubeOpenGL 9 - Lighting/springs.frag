@@ -0,0 +1,12 @@
+#version 330 core
+
+// Outputs colors in RGBA
+out vec4 FragColor;
+
+// Imports the strain color from the Vertex Shader
+in vec3 color;
+
+void main()
+{
+	FragColor = vec4(color, 1.0f);
+}
\ No newline at end of file
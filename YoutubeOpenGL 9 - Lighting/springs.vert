@@ -0,0 +1,41 @@
+#version 330 core
+
+// Two vertices per spring and no vertex buffers: gl_VertexID picks the spring and its end
+
+// Outputs the strain color for the Fragment Shader
+out vec3 color;
+
+// Particle positions: one GL_RGB32F texel each, or a flat x, y, z stream of GL_R32F texels
+uniform samplerBuffer positions;
+uniform int positionTexels = 3;
+// Springs as (i | j << 16, rest length bits) (GL_RG32UI texture buffer)
+uniform usamplerBuffer springs;
+// This jelly's first particle in the position buffer, and its topology's first spring
+uniform int particleBase;
+uniform int springFirst;
+// Imports the camera matrix from the main function
+uniform mat4 camMatrix;
+// Strain drawn fully red
+uniform float strainScale;
+
+
+vec3 particle(int i)
+{
+	if (positionTexels == 1) return texelFetch(positions, particleBase + i).rgb;
+	int base = 3 * (particleBase + i);
+	return vec3(texelFetch(positions, base).r, texelFetch(positions, base + 1).r, texelFetch(positions, base + 2).r);
+}
+
+void main()
+{
+	uvec2 spring = texelFetch(springs, springFirst + gl_VertexID / 2).rg;
+	vec3 a = particle(int(spring.x & 0xFFFFu));
+	vec3 b = particle(int(spring.x >> 16));
+	float rest = max(uintBitsToFloat(spring.y), 1e-6f);
+	gl_Position = camMatrix * vec4((gl_VertexID & 1) == 0 ? a : b, 1.0f);
+
+	// heat map of |len - rest| / rest: blue at rest, green halfway, red at strainScale
+	float heat = clamp(abs(length(b - a) - rest) / rest / strainScale, 0.0f, 1.0f);
+	color = heat < 0.5f ? mix(vec3(0.1f, 0.3f, 1.0f), vec3(0.1f, 1.0f, 0.2f), 2.0f * heat)
+	                    : mix(vec3(0.1f, 1.0f, 0.2f), vec3(1.0f, 0.1f, 0.05f), 2.0f * heat - 1.0f);
+}
\ No newline at end of file
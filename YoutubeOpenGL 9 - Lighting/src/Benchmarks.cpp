@@ -0,0 +1,978 @@
+#include "Benchmarks.h"
+#include "Jelly.h"
+#include "PhysicsWorld.h"
+#include "JobSystem.h"
+#include "GpuArena.h"
+#include "Frustum.h"
+#include "ClusteredLights.h"
+#include "Raycast.h"
+#include "Telemetry.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <glm/gtc/matrix_transform.hpp>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+int failures = 0; // checks that failed (benchmarks that have a pass/fail verdict)
+
+// Hardware cache-miss counter for the calling thread. Only available on Linux (and only
+// when perf events are permitted); elsewhere read() returns -1 and the column shows n/a.
+class CacheMissCounter {
+public:
+    explicit CacheMissCounter(bool l1)
+    {
+#ifdef __linux__
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        if (l1) {
+            attr.type = PERF_TYPE_HW_CACHE;
+            attr.config = PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        }
+        else {
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_CACHE_MISSES; // last-level cache
+        }
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd = (int)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+#else
+        (void)l1;
+#endif
+    }
+    ~CacheMissCounter()
+    {
+#ifdef __linux__
+        if (fd >= 0) close(fd);
+#endif
+    }
+    void start()
+    {
+#ifdef __linux__
+        if (fd < 0) return;
+        ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+#endif
+    }
+    long long read()
+    {
+#ifdef __linux__
+        if (fd < 0) return -1;
+        ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        long long count = 0;
+        if (::read(fd, &count, sizeof(count)) != (ssize_t)sizeof(count)) return -1;
+        return count;
+#else
+        return -1;
+#endif
+    }
+
+private:
+    int fd = -1;
+};
+
+ColliderSet benchBox()
+{
+    Container box;
+    box.min = glm::vec3(-4.0f, 0.0f, -4.0f);
+    box.max = glm::vec3(+4.0f, 4.0f, +4.0f);
+    return ColliderSet(box);
+}
+
+// mean |i - j| over all springs: how far apart in memory the two ends of a spring are
+double meanSpringSpan(const JellyTopology& t)
+{
+    double sum = 0.0;
+    for (int s = 0; s < t.springCount(); ++s) sum += std::abs(t.springI(s) - t.springJ(s));
+    return t.springCount() ? sum / t.springCount() : 0.0;
+}
+
+void formatCount(char* buf, size_t n, long long v)
+{
+    if (v < 0) std::snprintf(buf, n, "n/a");
+    else std::snprintf(buf, n, "%lld", v);
+}
+
+// Particle ordering / spring encoding: lattice order vs reverse Cuthill-McKee. Enough
+// bodies are stepped that the particle working set (~15 MB) does not sit in cache.
+void benchLayout()
+{
+    std::printf("\n== layout: particle order and spring encoding ==\n");
+    std::printf("%4s %6s %-8s %8s %8s %8s %9s %12s %14s %14s\n",
+        "S", "bodies", "order", "parts", "springs", "span", "idx bits", "Mspring/s", "L1D miss/step", "LLC miss/step");
+
+    const ColliderSet box = benchBox();
+    for (int S : { 32, 64 }) {
+        const int bodies = S <= 32 ? 64 : 16;
+        for (bool reorder : { false, true }) {
+            std::vector<std::unique_ptr<Jelly>> jellies;
+            for (int b = 0; b < bodies; ++b)
+                jellies.emplace_back(new Jelly(glm::vec3(0.0f, 1.5f, 0.0f), 1.0f, glm::vec3(0), glm::vec3(0),
+                    0.05f, 0.25f, S - 1, reorder));
+            auto topo = JellyTopology::Get(S - 1, 1.0f, 0.25f, reorder);
+
+            for (auto& j : jellies) j->Step(1.0f / 120.0f, box); // warm up
+
+            const int steps = 10;
+            CacheMissCounter l1(true), llc(false);
+            l1.start(); llc.start();
+            auto t0 = Clock::now();
+            for (int i = 0; i < steps; ++i)
+                for (auto& j : jellies) j->Step(1.0f / 120.0f, box);
+            double sec = std::chrono::duration<double>(Clock::now() - t0).count();
+            long long l1Miss = l1.read(), llcMiss = llc.read();
+
+            // Step runs 4 constraint passes over every spring
+            double springsPerSec = 4.0 * topo->springCount() * bodies * steps / sec;
+            char l1Buf[32], llcBuf[32];
+            formatCount(l1Buf, sizeof(l1Buf), l1Miss < 0 ? -1 : l1Miss / steps);
+            formatCount(llcBuf, sizeof(llcBuf), llcMiss < 0 ? -1 : llcMiss / steps);
+            std::printf("%4d %6d %-8s %8d %8d %8.1f %9d %12.1f %14s %14s\n",
+                S, bodies, reorder ? "rcm" : "lattice", topo->particleCount(), topo->springCount(),
+                meanSpringSpan(*topo), topo->springEnds16.empty() ? 32 : 16,
+                springsPerSec * 1e-6, l1Buf, llcBuf);
+        }
+    }
+}
+
+struct SolverVariant {
+    const char* name;
+    SolverMode mode;
+    float rho;
+    bool threaded;   // Jacobi passes split over JobSystem::Shared()
+};
+
+const SolverVariant solverVariants[] = {
+    { "gauss-seidel",     SolverMode::GaussSeidel, 0.0f,  false },
+    { "jacobi",           SolverMode::Jacobi,      0.0f,  false },
+    { "jacobi+chebyshev", SolverMode::Jacobi,      -1.0f, false }, // -1: keep the Jelly default rho
+    { "jacobi+cheb, jobs", SolverMode::Jacobi,     -1.0f, true },
+};
+
+// Gauss-Seidel vs Jacobi vs Chebyshev-accelerated Jacobi: residual after one step with a
+// given number of passes (starting from the same punched body), then step throughput.
+void benchSolver()
+{
+    std::printf("\n== solver: convergence (RMS strain after one step of a punched S=8 body) ==\n");
+    const int passCounts[] = { 1, 2, 4, 8, 16, 32 };
+    std::printf("%-18s", "passes");
+    for (int n : passCounts) std::printf(" %10d", n);
+    std::printf("\n");
+
+    const ColliderSet box = benchBox();
+    for (const SolverVariant& v : solverVariants) {
+        if (v.threaded) continue;   // converges exactly like the unthreaded run
+        std::printf("%-18s", v.name);
+        for (int n : passCounts) {
+            Jelly jelly(glm::vec3(0.0f, 1.5f, 0.0f), 1.0f, glm::vec3(0), glm::vec3(0), 0.05f, 0.25f, 7);
+            jelly.apply_punch();
+            jelly.apply_idle_wobble(0.4f);
+            jelly.solverMode = v.mode;
+            if (v.rho >= 0.0f) jelly.chebyshevRho = v.rho;
+            jelly.solverIterations = n;
+            jelly.Step(1.0f / 120.0f, box);
+            std::printf(" %10.5f", jelly.constraintResidual());
+        }
+        std::printf("\n");
+    }
+
+    std::printf("\n== solver: throughput (16 bodies, S=64, 4 passes per step, %d threads for jobs) ==\n",
+        JobSystem::Shared().threadCount());
+    std::printf("%-18s %12s %12s\n", "solver", "ms/step", "Mspring/s");
+    for (const SolverVariant& v : solverVariants) {
+        std::vector<std::unique_ptr<Jelly>> jellies;
+        for (int b = 0; b < 16; ++b) {
+            jellies.emplace_back(new Jelly(glm::vec3(0.0f, 1.5f, 0.0f), 1.0f, glm::vec3(0), glm::vec3(0), 0.05f, 0.25f, 63));
+            jellies.back()->solverMode = v.mode;
+            if (v.rho >= 0.0f) jellies.back()->chebyshevRho = v.rho;
+            if (v.threaded) jellies.back()->jobs = &JobSystem::Shared();
+        }
+        for (auto& j : jellies) j->Step(1.0f / 120.0f, box); // warm up
+
+        const int steps = 10;
+        auto t0 = Clock::now();
+        for (int i = 0; i < steps; ++i)
+            for (auto& j : jellies) j->Step(1.0f / 120.0f, box);
+        double sec = std::chrono::duration<double>(Clock::now() - t0).count();
+        auto topo = JellyTopology::Get(63, 1.0f, 0.25f);
+        std::printf("%-18s %12.3f %12.1f\n", v.name, 1e3 * sec / steps,
+            4.0 * topo->springCount() * jellies.size() * steps / sec * 1e-6);
+    }
+}
+
+#ifdef JELLY_BENCH_PD
+struct BackendVariant {
+    const char* name;
+    SolverBackend backend;
+    float hz;
+};
+
+const BackendVariant backendVariants[] = {
+    { "verlet-pbd 120Hz", SolverBackend::VerletPBD,          120.0f },
+    { "pd 60Hz",          SolverBackend::ProjectiveDynamics,  60.0f },
+    { "pd 30Hz",          SolverBackend::ProjectiveDynamics,  30.0f },
+};
+#endif
+
+// Verlet+PBD at its usual 120 Hz vs Projective Dynamics at 60 and 30 Hz: cost of one
+// simulated second for a body dropped onto the floor, and how well it holds its rest
+// shape once settled. The first PD step of each size also pays for the factorization.
+// PD is only compiled in with JELLY_BENCH_PD defined.
+void benchBackend()
+{
+#ifndef JELLY_BENCH_PD
+    std::printf("\n== backend: skipped, build with JELLY_BENCH_PD to compare Projective Dynamics ==\n");
+#else
+    std::printf("\n== backend: one body dropped and settled for 2 s ==\n");
+    std::printf("%4s %-18s %10s %12s %12s %12s %10s\n",
+        "S", "backend", "factor ms", "envelope", "ms/sim s", "RMS strain", "height");
+
+    const ColliderSet box = benchBox();
+    for (int S : { 9, 17, 33 }) {
+        for (const BackendVariant& v : backendVariants) {
+            Jelly jelly(glm::vec3(0.0f, 1.0f, 0.0f), 1.0f, glm::vec3(0), glm::vec3(0), 0.05f, 0.25f, S - 1);
+            jelly.backend = v.backend;
+            const float dt = 1.0f / v.hz;
+
+            auto t0 = Clock::now();
+            jelly.Step(dt, box);
+            double first = std::chrono::duration<double>(Clock::now() - t0).count();
+
+            const int steps = (int)(2.0f * v.hz);
+            t0 = Clock::now();
+            for (int i = 1; i < steps; ++i) jelly.Step(dt, box);
+            double sec = std::chrono::duration<double>(Clock::now() - t0).count();
+
+            char factorBuf[32], envBuf[32];
+            if (v.backend == SolverBackend::ProjectiveDynamics) {
+                auto sys = PDSystem::Get(JellyTopology::Get(S - 1, 1.0f, 0.25f), 0.05f, dt, jelly.pdStiffness);
+                std::snprintf(factorBuf, sizeof(factorBuf), "%.1f", 1e3 * first);
+                formatCount(envBuf, sizeof(envBuf), (long long)sys->factor.envelopeSize());
+            }
+            else {
+                std::snprintf(factorBuf, sizeof(factorBuf), "-");
+                std::snprintf(envBuf, sizeof(envBuf), "-");
+            }
+            std::printf("%4d %-18s %10s %12s %12.2f %12.5f %10.3f\n", S, v.name, factorBuf, envBuf,
+                1e3 * sec * v.hz / (steps - 1), jelly.constraintResidual(), (jelly.getMax() - jelly.getMin()).y);
+        }
+    }
+#endif
+}
+
+struct VolumeVariant {
+    const char* name;
+    VolumeMode mode;
+};
+
+const VolumeVariant volumeVariants[] = {
+    { "body springs", VolumeMode::BodySprings },
+    { "constraint",   VolumeMode::Constraint },
+    { "gas pressure", VolumeMode::GasPressure },
+};
+
+// Body springs vs one volume constraint vs gas pressure: springs per body, Step cost for
+// 16 bodies, and the shape after dropping one body and letting it settle for 2 s.
+void benchVolume()
+{
+    std::printf("\n== volume: what keeps the body from collapsing ==\n");
+    std::printf("%4s %-14s %8s %10s %10s %10s %10s\n",
+        "S", "mode", "springs", "ms/step", "Mspring/s", "height", "volume");
+
+    const ColliderSet box = benchBox();
+    for (int S : { 9, 17, 33 }) {
+        for (const VolumeVariant& v : volumeVariants) {
+            std::vector<std::unique_ptr<Jelly>> jellies;
+            for (int b = 0; b < 16; ++b)
+                jellies.emplace_back(new Jelly(glm::vec3(0.0f, 1.5f, 0.0f), 1.0f, glm::vec3(0), glm::vec3(0),
+                    0.05f, 0.25f, S - 1, true, v.mode));
+            for (auto& j : jellies) j->Step(1.0f / 120.0f, box); // warm up
+
+            const int steps = 20;
+            auto t0 = Clock::now();
+            for (int i = 0; i < steps; ++i)
+                for (auto& j : jellies) j->Step(1.0f / 120.0f, box);
+            double sec = std::chrono::duration<double>(Clock::now() - t0).count();
+            const int springs = jellies[0]->springCount();
+
+            Jelly& settled = *jellies[0];
+            for (int i = 0; i < 240; ++i) settled.Step(1.0f / 120.0f, box);
+
+            std::printf("%4d %-14s %8d %10.3f %10.1f %10.3f %10.3f\n", S, v.name, springs,
+                1e3 * sec / steps, 4.0 * springs * jellies.size() * steps / sec * 1e-6,
+                (settled.getMax() - settled.getMin()).y, settled.volumeRatio());
+        }
+    }
+}
+
+// Every volume mode through a hard landing and a series of punches, at 120 and 60 Hz: the
+// body is dropped from 3 m (about 7 m/s at impact), settles for a second, then is punched
+// once every 0.1 s for half a second and settles again. A run fails if the volume ever goes
+// non-finite, collapses (volumeCollapsed) or non-positive, or grows past twice rest, or the
+// body ends up taller than three times its size. Body springs are checked up to S = 9
+// (what the demo runs at 60 Hz) and only listed above: they resist no shear across the
+// body, so at S >= 17 the punches shear the cube flat at either rate.
+void benchStability()
+{
+    std::printf("\n== stability: drop from 3 m, then 5 punches ==\n");
+    std::printf("%4s %-14s %5s %10s %10s %10s %10s %6s\n",
+        "S", "mode", "Hz", "min vol", "max vol", "max h", "height", "");
+
+    const ColliderSet box = benchBox();
+    for (int S : { 3, 5, 9, 17, 33 }) {
+        for (const VolumeVariant& v : volumeVariants) {
+            for (float hz : { 120.0f, 60.0f }) {
+                Jelly jelly(glm::vec3(0.0f, 3.0f, 0.0f), 1.0f, glm::vec3(0), glm::vec3(0),
+                    0.05f, 0.25f, S - 1, true, v.mode);
+                const float size = (jelly.getMax() - jelly.getMin()).y;
+                const int second = (int)hz, punchEvery = (int)(0.1f * hz);
+
+                float minVolume = 1.0f, maxVolume = 1.0f, maxHeight = 0.0f;
+                bool collapsed = false;
+                for (int i = 0; i < 3 * second; ++i) {
+                    if (i >= second && i < second + 5 * punchEvery && (i - second) % punchEvery == 0)
+                        jelly.apply_punch();
+                    jelly.Step(1.0f / hz, box);
+
+                    float ratio = jelly.volumeRatio();
+                    if (!std::isfinite(ratio)) ratio = -1.0f;
+                    minVolume = std::min(minVolume, ratio);
+                    maxVolume = std::max(maxVolume, ratio);
+                    maxHeight = std::max(maxHeight, (jelly.getMax() - jelly.getMin()).y);
+                    collapsed |= jelly.volumeCollapsed();
+                }
+                const float height = (jelly.getMax() - jelly.getMin()).y;
+                const bool checked = v.mode != VolumeMode::BodySprings || S <= 9;
+                const bool ok = !collapsed && minVolume > 0.0f && maxVolume < 2.0f &&
+                    std::isfinite(maxHeight) && maxHeight < 3.0f * size;
+                if (checked && !ok) ++failures;
+
+                std::printf("%4d %-14s %5.0f %10.3f %10.3f %10.3f %10.3f %6s\n", S, v.name, hz,
+                    minVolume, maxVolume, maxHeight, height, !checked ? "-" : ok ? "ok" : "FAIL");
+            }
+        }
+    }
+}
+
+// An arena with `obstacles` colliders of every type scattered on a grid around the bodies
+// (cycling sphere, capsule, box, height field), all out of reach of bodies resting at the
+// center.
+ColliderSet benchArena(int obstacles)
+{
+    ColliderSet arena(benchBox());
+    std::vector<float> bumps(8 * 8, 0.1f);
+    for (int k = 0, cell = 0; k < obstacles; ++cell) {
+        // 15 x 15 grid, 0.5 apart, stacked in layers when full; the middle stays clear
+        const int gx = cell % 15, gz = (cell / 15) % 15, layer = cell / 225;
+        const float x = -3.5f + 0.5f * (float)gx, z = -3.5f + 0.5f * (float)gz;
+        if (std::abs(x) < 1.75f && std::abs(z) < 1.75f) continue;
+        const glm::vec3 c(x, 0.1f + 0.3f * (float)layer, z);
+        switch (k++ % 4) {
+        case 0: arena.addSphere(c, 0.1f); break;
+        case 1: arena.addCapsule(c - glm::vec3(0.1f, 0, 0), c + glm::vec3(0.1f, 0, 0), 0.05f); break;
+        case 2: arena.addBox(c, glm::vec3(0.1f)); break;
+        default: arena.addHeightField(c - glm::vec3(0.2f, 0.1f, 0.2f), 0.05f, 8, 8, bumps); break;
+        }
+    }
+    return arena;
+}
+
+// Collision cost as the scene grows: 16 resting S=17 bodies in an arena with more and more
+// obstacles around them, with and without the bounds cull.
+void benchColliders()
+{
+    std::printf("\n== colliders: 16 S=17 bodies, obstacles out of their reach ==\n");
+    std::printf("%10s %8s %12s\n", "colliders", "cull", "ms/step");
+
+    for (int obstacles : { 0, 16, 64, 256 }) {
+        for (bool cull : { true, false }) {
+            ColliderSet arena = benchArena(obstacles);
+            arena.cullAgainstBounds = cull;
+
+            std::vector<std::unique_ptr<Jelly>> jellies;
+            for (int b = 0; b < 16; ++b)
+                jellies.emplace_back(new Jelly(glm::vec3(-0.9f + 0.6f * (b % 4), 0.26f, -0.9f + 0.6f * (b / 4)),
+                    0.5f, glm::vec3(0), glm::vec3(0), 0.05f, 0.25f, 16));
+            for (int i = 0; i < 30; ++i)
+                for (auto& j : jellies) j->Step(1.0f / 60.0f, arena); // settle onto the floor
+
+            const int steps = 20;
+            auto t0 = Clock::now();
+            for (int i = 0; i < steps; ++i)
+                for (auto& j : jellies) j->Step(1.0f / 60.0f, arena);
+            double sec = std::chrono::duration<double>(Clock::now() - t0).count();
+            std::printf("%10d %8s %12.3f\n", (int)arena.size(), cull ? "on" : "off", 1e3 * sec / steps);
+        }
+    }
+}
+
+// Closed torus around the y axis: `around` segments along the ring, `tube` around the tube.
+void torusMesh(float R, float r, int around, int tube, std::vector<glm::vec3>& vertices, std::vector<uint32_t>& indices)
+{
+    vertices.clear();
+    indices.clear();
+    for (int a = 0; a < around; ++a)
+        for (int t = 0; t < tube; ++t) {
+            const float u = 6.2831853f * a / around, v = 6.2831853f * t / tube;
+            vertices.push_back(glm::vec3((R + r * std::cos(v)) * std::cos(u), r * std::sin(v), (R + r * std::cos(v)) * std::sin(u)));
+        }
+    for (int a = 0; a < around; ++a)
+        for (int t = 0; t < tube; ++t) {
+            const uint32_t i00 = a * tube + t, i01 = a * tube + (t + 1) % tube;
+            const uint32_t i10 = ((a + 1) % around) * tube + t, i11 = ((a + 1) % around) * tube + (t + 1) % tube;
+            indices.insert(indices.end(), { i00, i01, i11, i00, i11, i10 });
+        }
+}
+
+// Baked mesh colliders: bake / load cost and accuracy against the analytic torus, and the
+// per-particle query cost, which should not depend on the triangle count.
+void benchSdf()
+{
+    std::printf("\n== sdf: torus R=1.2 r=0.35 baked at 0.04, 16 S=9 bodies dropped on it ==\n");
+    std::printf("%8s %12s %10s %10s %8s %10s %12s %10s\n",
+        "tris", "samples", "bake ms", "load ms", "MB", "surf err", "ns/particle", "ms/step");
+
+    const float R = 1.2f, r = 0.35f;
+    const char* cachePath = "bench_torus.sdf";
+
+    // a fixed particle cloud over the field (plus a margin) for the query timing
+    std::vector<Particle> cloud(1 << 16);
+    unsigned seed = 12345;
+    auto rnd = [&seed]() { seed = seed * 1664525u + 1013904223u; return (seed >> 8) * (1.0f / 16777216.0f); };
+    for (Particle& p : cloud) {
+        p.p = glm::vec3(-1.8f + 3.6f * rnd(), -0.6f + 1.2f * rnd(), -1.8f + 3.6f * rnd());
+        p.prev = p.p;
+        p.a = glm::vec3(0.0f);
+        p.invMass = 1.0f;
+    }
+
+    for (int around : { 16, 64, 256, 512 }) {
+        std::vector<glm::vec3> vertices;
+        std::vector<uint32_t> indices;
+        torusMesh(R, r, around, around / 2, vertices, indices);
+
+        std::remove(cachePath);
+        auto t0 = Clock::now();
+        auto baked = SignedDistanceField::LoadOrBake(cachePath, vertices, indices, 0.04f, 0.1f);
+        const double bakeMs = 1e3 * std::chrono::duration<double>(Clock::now() - t0).count();
+        t0 = Clock::now();
+        auto sdf = SignedDistanceField::LoadOrBake(cachePath, vertices, indices, 0.04f, 0.1f);
+        const double loadMs = 1e3 * std::chrono::duration<double>(Clock::now() - t0).count();
+        if (!baked || !sdf || !sdf->isMapped()) {
+            std::printf("%8d bake or cache failed\n", (int)indices.size() / 3);
+            continue;
+        }
+
+        // within 0.1 of the surface, where collisions happen
+        float maxErr = 0.0f;
+        for (const Particle& p : cloud) {
+            const glm::vec2 q(std::sqrt(p.p.x * p.p.x + p.p.z * p.p.z) - R, p.p.y);
+            const float exact = glm::length(q) - r;
+            if (std::abs(exact) < 0.1f) maxErr = std::max(maxErr, std::abs(sdf->distance(p.p) - exact));
+        }
+
+        ColliderSet scene(benchBox());
+        scene.addMesh(sdf, glm::vec3(0.0f, r, 0.0f));
+        ColliderSet meshOnly;
+        meshOnly.addMesh(sdf, glm::vec3(0.0f));
+        std::vector<ColliderContact> contacts;
+        const int queries = 20;
+        t0 = Clock::now();
+        for (int i = 0; i < queries; ++i) {
+            contacts.clear();
+            meshOnly.findContacts(cloud, glm::vec3(-2.0f), glm::vec3(2.0f), 0.0f, contacts);
+        }
+        const double ns = 1e9 * std::chrono::duration<double>(Clock::now() - t0).count() / (queries * cloud.size());
+
+        std::vector<std::unique_ptr<Jelly>> jellies;
+        for (int b = 0; b < 16; ++b) {
+            const float u = 6.2831853f * b / 16;
+            jellies.emplace_back(new Jelly(glm::vec3(R * std::cos(u), 1.2f + 0.1f * (b % 2), R * std::sin(u)),
+                0.3f, glm::vec3(0), glm::vec3(0), 0.05f, 0.25f, 8));
+        }
+        for (int i = 0; i < 30; ++i)
+            for (auto& j : jellies) j->Step(1.0f / 60.0f, scene);
+        const int steps = 20;
+        t0 = Clock::now();
+        for (int i = 0; i < steps; ++i)
+            for (auto& j : jellies) j->Step(1.0f / 60.0f, scene);
+        const double stepMs = 1e3 * std::chrono::duration<double>(Clock::now() - t0).count() / steps;
+
+        std::printf("%8d %12zu %10.1f %10.3f %8.2f %10.4f %12.2f %10.3f\n", (int)indices.size() / 3,
+            sdf->sampleCount(), bakeMs, loadMs, sdf->sampleCount() * 4.0 / (1 << 20), maxErr, ns, stepMs);
+    }
+    std::remove(cachePath);
+}
+
+// 1, 2, 4, 8, then powers of two up to the hardware thread count, and that count itself.
+// The oversubscribed ones on small machines still exercise the threading.
+std::vector<int> benchThreadCounts()
+{
+    const int hw = (int)std::max(1u, std::thread::hardware_concurrency());
+    std::vector<int> counts{ 1, 2, 4, 8 };
+    for (int t = 16; t < hw; t *= 2) counts.push_back(t);
+    if (hw > 8) counts.push_back(hw);
+    return counts;
+}
+
+// FNV-1a over every body's bounds: equal runs give equal checksums
+uint64_t worldChecksum(PhysicsWorld& world)
+{
+    uint64_t h = 1469598103934665603ull;
+    for (size_t i = 0; i < world.bodyCount(); ++i) {
+        const glm::vec3 b[2] = { world.body(i).getMin(), world.body(i).getMax() };
+        const unsigned char* p = (const unsigned char*)b;
+        for (size_t k = 0; k < sizeof(b); ++k) { h ^= p[k]; h *= 1099511628211ull; }
+    }
+    return h;
+}
+
+// Island-parallel stepping: 64 S=9 bodies on an 8 x 8 grid, every fourth one with a second
+// body dropped onto it (so islands of one and two), stepped with 1..N threads. The checksum
+// must not change with the thread count.
+void benchWorld()
+{
+    const int hw = (int)std::max(1u, std::thread::hardware_concurrency());
+    std::printf("\n== world: 80 S=9 bodies, island-parallel (%d hardware threads) ==\n", hw);
+    std::printf("%8s %8s %12s %10s %18s\n", "threads", "islands", "steps/s", "speedup", "checksum");
+
+    double base = 0.0;
+    for (int threads : benchThreadCounts()) {
+        JobSystem jobs(threads);
+        PhysicsWorld world(benchBox(), jobs);
+        for (int b = 0; b < 64; ++b) {
+            const glm::vec3 c(-3.15f + 0.9f * (b % 8), 0.16f, -3.15f + 0.9f * (b / 8));
+            world.add(std::make_unique<Jelly>(c, 0.3f, glm::vec3(0), glm::vec3(0), 0.05f, 0.25f, 8));
+            if (b % 4 == 0)
+                world.add(std::make_unique<Jelly>(c + glm::vec3(0.05f, 0.5f, 0.0f), 0.3f, glm::vec3(0), glm::vec3(0),
+                    0.05f, 0.25f, 8));
+        }
+        for (int i = 0; i < 30; ++i) world.step(1.0f / 60.0f);
+
+        const int steps = 60;
+        auto t0 = Clock::now();
+        for (int i = 0; i < steps; ++i) world.step(1.0f / 60.0f);
+        const double rate = steps / std::chrono::duration<double>(Clock::now() - t0).count();
+        if (threads == 1) base = rate;
+        std::printf("%8d %8d %12.1f %10.2f %18llx\n", world.threadCount(), world.islandCount(), rate, rate / base,
+            (unsigned long long)worldChecksum(world));
+    }
+}
+
+// a few hundred ns of dependent float math, so the optimizer cannot drop it
+float busyWork(int i)
+{
+    float x = (float)i * 1e-3f;
+    for (int k = 0; k < 64; ++k) x = x * 0.999f + std::sqrt(x + 1.0f) * 1e-3f;
+    return x;
+}
+
+// Job system: per-job overhead (spawn + run + wait), dependency chains, parallel-for grain
+// overhead, and parallel-for scaling on compute-bound work.
+void benchScheduler()
+{
+    const int hw = (int)std::max(1u, std::thread::hardware_concurrency());
+    std::printf("\n== scheduler: job system overhead and scaling (%d hardware threads) ==\n", hw);
+    std::printf("%8s %12s %12s %12s %12s %12s %10s\n", "threads", "ns/job", "ns/dep-link",
+        "grain 1 ns", "grain 64 ns", "for ms", "speedup");
+
+    const int jobCount = 100000, chainLength = 20000, forCount = 1 << 20, workCount = 1 << 18;
+    double base = 0.0;
+    for (int threads : benchThreadCounts()) {
+        JobSystem jobs(threads);
+
+        // independent empty jobs, spawned from outside and helped along while waiting
+        std::atomic<int> done{ 0 };
+        auto t0 = Clock::now();
+        for (int i = 0; i < jobCount; ++i) jobs.spawn([&done] { done.fetch_add(1, std::memory_order_relaxed); });
+        jobs.helpUntil([&] { return done.load() == jobCount; });
+        const double nsJob = 1e9 * std::chrono::duration<double>(Clock::now() - t0).count() / jobCount;
+
+        // a chain where every job waits on the previous one
+        t0 = Clock::now();
+        JobSystem::Handle last;
+        for (int i = 0; i < chainLength; ++i) last = jobs.spawn([] {}, { last });
+        jobs.wait(last);
+        const double nsLink = 1e9 * std::chrono::duration<double>(Clock::now() - t0).count() / chainLength;
+
+        // parallel-for over trivial items: scheduling cost per item at two grain sizes
+        std::vector<float> out(forCount);
+        double nsGrain[2];
+        const int grains[2] = { 1, 64 };
+        for (int g = 0; g < 2; ++g) {
+            t0 = Clock::now();
+            jobs.parallelFor(forCount, grains[g], [&](int b, int e) {
+                for (int i = b; i < e; ++i) out[i] = (float)i * 0.5f;
+                });
+            nsGrain[g] = 1e9 * std::chrono::duration<double>(Clock::now() - t0).count() / forCount;
+        }
+
+        // parallel-for over real work with the automatic grain
+        std::vector<float> work(workCount);
+        t0 = Clock::now();
+        jobs.parallelFor(workCount, 0, [&](int b, int e) {
+            for (int i = b; i < e; ++i) work[i] = busyWork(i);
+            });
+        const double forMs = 1e3 * std::chrono::duration<double>(Clock::now() - t0).count();
+        if (threads == 1) base = forMs;
+
+        std::printf("%8d %12.1f %12.1f %12.1f %12.2f %12.2f %10.2f\n", jobs.threadCount(), nsJob, nsLink,
+            nsGrain[0], nsGrain[1], forMs, base / forMs);
+    }
+}
+
+// Render-buffer sub-allocation: bodies of mixed sizes (6*S^2 face vertices, S = 3..9)
+// spawned and despawned at random around a steady population, as the jelly mesh pool sees
+// them. Reports the cost per allocate/free pair and how fragmented the free space gets
+// (GpuArena compacts when no gap fits, so this is how often that would be needed).
+void benchSuballoc()
+{
+    std::printf("\n== suballoc: free-list ranges under spawn/despawn churn ==\n");
+    std::printf("%10s %10s %12s %12s %12s %12s\n", "population", "capacity", "ns/pair", "free blocks",
+        "fragment.", "compactions");
+
+    for (int population : { 256, 4096, 32768 }) {
+        uint32_t rng = 12345u;
+        auto next = [&rng] { rng = rng * 1664525u + 1013904223u; return rng >> 8; };
+        auto bodySize = [&] { const size_t S = 3 + next() % 7; return 6 * S * S; };
+
+        // capacity with ~25% headroom over the average population
+        const size_t capacity = (size_t)(population * 6 * 36 * 1.25);
+        RangeAllocator alloc(capacity);
+        std::vector<std::pair<size_t, size_t>> live;   // first, count
+        while ((int)live.size() < population) {
+            const size_t n = bodySize();
+            live.push_back({ alloc.allocate(n), n });
+        }
+
+        const int churn = 200000;
+        int compactions = 0;
+        auto t0 = Clock::now();
+        for (int i = 0; i < churn; ++i) {
+            const size_t k = next() % live.size();
+            alloc.free(live[k].first, live[k].second);
+            const size_t n = bodySize();
+            size_t first = alloc.allocate(n);
+            if (first == RangeAllocator::npos) {
+                // what GpuArena does when a gap is missing: slide everything down
+                live[k] = live.back();
+                live.pop_back();
+                std::sort(live.begin(), live.end());
+                size_t cursor = 0;
+                for (auto& r : live) { r.first = cursor; cursor += r.second; }
+                alloc.compacted(cursor);
+                ++compactions;
+                first = alloc.allocate(n);
+                live.push_back({ first, n });
+                continue;
+            }
+            live[k] = { first, n };
+        }
+        const double nsPair = 1e9 * std::chrono::duration<double>(Clock::now() - t0).count() / churn;
+        const size_t freeSpace = alloc.capacity() - alloc.used();
+        const double frag = freeSpace ? 1.0 - (double)alloc.largestFree() / freeSpace : 0.0;
+        std::printf("%10d %10zu %12.1f %12zu %12.2f %12d\n", population, capacity, nsPair,
+            alloc.freeBlockCount(), frag, compactions);
+    }
+}
+
+// View-frustum culling: the box test one at a time against the batched structure-of-arrays
+// test (which must agree), and what culling saves on the render side for a grid of bodies
+// seen from one corner, where only part of the grid is on screen.
+void benchFrustum()
+{
+    std::printf("\n== frustum: AABB culling ==\n");
+
+    const glm::mat4 proj = glm::perspective(glm::radians(45.0f), 1.0f, 0.1f, 100.0f);
+    const glm::mat4 view = glm::lookAt(glm::vec3(-10.0f, 3.0f, -10.0f), glm::vec3(0.0f), glm::vec3(0, 1, 0));
+    const Frustum frustum = Frustum::FromMatrix(proj * view);
+
+    uint32_t rng = 777u;
+    auto next = [&rng] { rng = rng * 1664525u + 1013904223u; return (float)(rng >> 8) / 16777216.0f; };
+    const int boxCount = 1 << 18;
+    BoxList boxes;
+    std::vector<glm::vec3> mins, maxs;
+    for (int i = 0; i < boxCount; ++i) {
+        const glm::vec3 c(next() * 60.0f - 30.0f, next() * 10.0f, next() * 60.0f - 30.0f);
+        const glm::vec3 h(0.2f + 0.3f * next());
+        boxes.push(c - h, c + h);
+        mins.push_back(c - h);
+        maxs.push_back(c + h);
+    }
+
+    const int reps = 20;
+    std::vector<uint32_t> one(boxCount), batched;
+    auto t0 = Clock::now();
+    for (int r = 0; r < reps; ++r)
+        for (int i = 0; i < boxCount; ++i) one[i] = frustum.intersects(mins[i], maxs[i]);
+    const double nsOne = 1e9 * std::chrono::duration<double>(Clock::now() - t0).count() / ((double)reps * boxCount);
+    t0 = Clock::now();
+    for (int r = 0; r < reps; ++r) frustum.cull(boxes, batched);
+    const double nsBatch = 1e9 * std::chrono::duration<double>(Clock::now() - t0).count() / ((double)reps * boxCount);
+    int inside = 0, mismatches = 0;
+    for (int i = 0; i < boxCount; ++i) {
+        inside += batched[i];
+        mismatches += one[i] != batched[i];
+    }
+    std::printf("%d boxes, %d visible: %.2f ns/box one at a time, %.2f ns/box batched, %d mismatches\n",
+        boxCount, inside, nsOne, nsBatch, mismatches);
+
+    // render-side vertex rebuild for a 16 x 16 grid of S=9 bodies: all of them vs the visible ones
+    std::vector<std::unique_ptr<Jelly>> grid;
+    for (int z = 0; z < 16; ++z)
+        for (int x = 0; x < 16; ++x)
+            grid.push_back(std::make_unique<Jelly>(glm::vec3(-15.0f + 2.0f * x, 0.3f, -15.0f + 2.0f * z), 0.3f,
+                glm::vec3(0), glm::vec3(0), 0.05f, 0.25f, 8));
+    BoxList gridBoxes;
+    for (const auto& j : grid) gridBoxes.push(j->getMin(), j->getMax());
+    std::vector<uint32_t> gridVisible;
+
+    const int frames = 50;
+    t0 = Clock::now();
+    for (int f = 0; f < frames; ++f)
+        for (auto& j : grid) j->BuildRenderVertices();
+    const double msAll = 1e3 * std::chrono::duration<double>(Clock::now() - t0).count() / frames;
+    int shown = 0;
+    t0 = Clock::now();
+    for (int f = 0; f < frames; ++f) {
+        frustum.cull(gridBoxes, gridVisible);
+        shown = 0;
+        for (size_t i = 0; i < grid.size(); ++i)
+            if (gridVisible[i]) { grid[i]->BuildRenderVertices(); ++shown; }
+    }
+    const double msCulled = 1e3 * std::chrono::duration<double>(Clock::now() - t0).count() / frames;
+    std::printf("%zu bodies, %d visible: rebuild %.3f ms/frame for all, %.3f ms/frame culled (test included)\n",
+        grid.size(), shown, msAll, msCulled);
+}
+
+void benchClusters()
+{
+    std::printf("\n== clusters: point light binning ==\n");
+
+    // Main's camera looking into the box, lights scattered through it; slices end a little
+    // beyond the box
+    const float fov = 45.0f, nearPlane = 0.1f, farPlane = 100.0f, sliceFar = 5.0f;
+    const glm::mat4 view = glm::lookAt(glm::vec3(0.0f, 0.5f, 0.9f), glm::vec3(0.0f, 0.5f, -0.1f), glm::vec3(0, 1, 0));
+    const glm::mat4 proj = glm::perspective(glm::radians(fov), 1.0f, nearPlane, farPlane);
+    uint32_t rng = 4242u;
+    auto next = [&rng] { rng = rng * 1664525u + 1013904223u; return (float)(rng >> 8) / 16777216.0f; };
+
+    // sample points in the box, visible from the camera
+    std::vector<glm::vec3> points;
+    while (points.size() < 20000) {
+        const glm::vec3 p(next() * 2.0f - 1.0f, next() * 1.2f, next() * 2.0f - 1.0f);
+        const glm::vec4 clip = proj * view * glm::vec4(p, 1.0f);
+        if (clip.w > nearPlane && std::fabs(clip.x) < clip.w && std::fabs(clip.y) < clip.w) points.push_back(p);
+    }
+
+    for (int lightCount : { 64, 256, 1024, 4096 }) {
+        std::vector<PointLight> lights(lightCount);
+        for (PointLight& l : lights)
+            l = { glm::vec3(next() * 2.0f - 1.0f, next() * 1.2f, next() * 2.0f - 1.0f), 0.05f + 0.15f * next(), glm::vec3(1.0f) };
+
+        LightClusters clusters;
+        const int frames = 50;
+        auto t0 = Clock::now();
+        for (int f = 0; f < frames; ++f) clusters.bin(lights, view, fov, 1.0f, nearPlane, sliceFar);
+        const double usBin = 1e6 * std::chrono::duration<double>(Clock::now() - t0).count() / frames;
+
+        // per sample, the lights its cluster lists vs the ones that actually reach it; a
+        // reaching light missing from the list would be a binning bug
+        long long listed = 0, reaching = 0, missed = 0;
+        const glm::vec2 depthScale = clusters.depthScale();
+        for (const glm::vec3& p : points) {
+            const glm::vec4 clip = proj * view * glm::vec4(p, 1.0f);
+            const float depth = -(view * glm::vec4(p, 1.0f)).z;
+            const int x = std::min((int)((clip.x / clip.w * 0.5f + 0.5f) * LightClusters::tilesX), LightClusters::tilesX - 1);
+            const int y = std::min((int)((clip.y / clip.w * 0.5f + 0.5f) * LightClusters::tilesY), LightClusters::tilesY - 1);
+            const int z = std::min(std::max((int)std::floor(std::log(depth) * depthScale.x + depthScale.y), 0), LightClusters::slices - 1);
+            const int c = (z * LightClusters::tilesY + y) * LightClusters::tilesX + x;
+            const uint32_t first = clusters.ranges[2 * c], count = clusters.ranges[2 * c + 1];
+            listed += count;
+            for (int i = 0; i < lightCount; ++i) {
+                if (glm::length(lights[i].position - p) >= lights[i].radius) continue;
+                ++reaching;
+                bool found = false;
+                for (uint32_t k = first; k < first + count && !found; ++k) found = clusters.indices[k] == (uint32_t)i;
+                missed += !found;
+            }
+        }
+        std::printf("%5d lights: bin %8.1f us/frame, %7zu entries; per fragment %6.2f lights looped, %5.2f reach it (%lld missed)\n",
+            lightCount, usBin, clusters.indices.size(), (double)listed / points.size(), (double)reaching / points.size(), missed);
+    }
+}
+
+void benchRaycast()
+{
+    std::printf("\n== raycast: picking rays against a world of bodies ==\n");
+
+    // a 64 x 64 grid of S=9 bodies at rest, seen from above at an angle
+    const int side = 64;
+    const float radius = 0.3f;
+    PhysicsWorld world;
+    std::vector<glm::vec3> centers;
+    for (int z = 0; z < side; ++z)
+        for (int x = 0; x < side; ++x) {
+            const glm::vec3 c(-side + 2.0f * x, radius + 0.1f * (float)((x * 7 + z * 3) % 5), -side + 2.0f * z);
+            centers.push_back(c);
+            world.add(std::make_unique<Jelly>(c, radius, glm::vec3(0), glm::vec3(0), 0.05f, 0.25f, 8));
+        }
+    const JellyTopology& topo = *JellyTopology::Get(8, radius, 0.25f);
+    const glm::mat4 viewProjection = glm::perspective(glm::radians(45.0f), 1.0f, 0.1f, 500.0f) *
+        glm::lookAt(glm::vec3(0.0f, 40.0f, 70.0f), glm::vec3(0.0f), glm::vec3(0, 1, 0));
+
+    uint32_t rng = 99u;
+    auto next = [&rng] { rng = rng * 1664525u + 1013904223u; return (float)(rng >> 8) / 16777216.0f; };
+    std::vector<Ray> rays;
+    for (int i = 0; i < 2000; ++i) rays.push_back(Ray::FromScreen(viewProjection, next() * 800.0, next() * 800.0, 800, 800));
+    const float maxT = 500.0f;
+
+    // accelerated (world boxes, then patches of the nearest candidates) vs testing every
+    // body's patches, vs every triangle of every body as the reference
+    std::vector<RayHit> fast(rays.size()), scan(rays.size());
+    std::vector<uint8_t> fastHit(rays.size()), scanHit(rays.size());
+    world.raycast(rays[0], maxT, fast[0]);   // first call builds the box list
+    auto t0 = Clock::now();
+    for (size_t r = 0; r < rays.size(); ++r) fastHit[r] = world.raycast(rays[r], maxT, fast[r]);
+    const double usFast = 1e6 * std::chrono::duration<double>(Clock::now() - t0).count() / rays.size();
+    t0 = Clock::now();
+    for (size_t r = 0; r < rays.size(); ++r) {
+        float best = maxT;
+        scanHit[r] = 0;
+        for (size_t b = 0; b < world.bodyCount(); ++b)
+            if (world.body(b).raycast(rays[r], best, scan[r])) { scan[r].body = (int)b; best = scan[r].t; scanHit[r] = 1; }
+    }
+    const double usScan = 1e6 * std::chrono::duration<double>(Clock::now() - t0).count() / rays.size();
+
+    const int checked = 100;
+    int hits = 0, mismatches = 0;
+    t0 = Clock::now();
+    for (int r = 0; r < checked; ++r) {
+        float best = maxT, d, u, v;
+        int body = -1;
+        for (size_t b = 0; b < centers.size(); ++b)
+            for (size_t t = 0; t < topo.volumeTris.size(); t += 3)
+                if (rayTriangle(rays[r], centers[b] + topo.restOffsets[topo.volumeTris[t]], centers[b] + topo.restOffsets[topo.volumeTris[t + 1]],
+                    centers[b] + topo.restOffsets[topo.volumeTris[t + 2]], best, d, u, v)) { best = d; body = (int)b; }
+        hits += body >= 0;
+        mismatches += fastHit[r] != (body >= 0) || (body >= 0 && (fast[r].body != body || std::fabs(fast[r].t - best) > 1e-4f));
+    }
+    const double usBrute = 1e6 * std::chrono::duration<double>(Clock::now() - t0).count() / checked;
+    for (size_t r = 0; r < rays.size(); ++r)
+        mismatches += fastHit[r] != scanHit[r] || (fastHit[r] && fast[r].body != scan[r].body);
+
+    std::printf("%zu bodies, %d triangles each: %.2f us/query accelerated, %.1f us/query every body's patches, "
+        "%.0f us/query every triangle\n", world.bodyCount(), (int)topo.volumeTris.size() / 3, usFast, usScan, usBrute);
+    std::printf("%d of the first %d rays hit; %d mismatches against the scans\n", hits, checked, mismatches);
+}
+
+// Cost of the per step, per body stats (off, on), and what they say about the solver's
+// iteration count.
+void benchTelemetry()
+{
+    std::printf("\n== telemetry: per step, per body stats on the world benchmark's scene ==\n");
+    std::printf("%10s %10s %12s %14s %14s %12s %10s\n", "iterations", "telemetry", "steps/s", "max residual",
+        "max strain", "energy", "contacts");
+
+    for (int iterations : { 2, 4, 8 }) {
+        for (bool on : { false, true }) {
+            PhysicsWorld world(benchBox());
+            for (int b = 0; b < 64; ++b) {
+                const glm::vec3 c(-3.15f + 0.9f * (b % 8), 0.16f, -3.15f + 0.9f * (b / 8));
+                world.add(std::make_unique<Jelly>(c, 0.3f, glm::vec3(0), glm::vec3(0), 0.05f, 0.25f, 8)).solverIterations = iterations;
+                if (b % 4 == 0)
+                    world.add(std::make_unique<Jelly>(c + glm::vec3(0.05f, 0.5f, 0.0f), 0.3f, glm::vec3(0), glm::vec3(0),
+                        0.05f, 0.25f, 8)).solverIterations = iterations;
+            }
+            Telemetry telemetry;
+            if (on) world.telemetry = &telemetry;
+            const int steps = 90;
+            auto t0 = Clock::now();
+            for (int i = 0; i < steps; ++i) world.step(1.0f / 60.0f);
+            const double rate = steps / std::chrono::duration<double>(Clock::now() - t0).count();
+            if (!on) {
+                std::printf("%10d %10s %12.1f\n", iterations, "off", rate);
+                continue;
+            }
+            // averaged over the steps once the stacked bodies have landed
+            double residual = 0.0, energy = 0.0, contacts = 0.0;
+            float strain = 0.0f;
+            const int from = 30;
+            for (int st = from; st < steps; ++st) {
+                const StepTotals t = telemetry.totals(st);
+                residual += t.maxResidual;
+                strain = std::max(strain, t.maxStrain);
+                energy += t.kinetic + t.potential;
+                contacts += t.colliderContacts + t.bodyContacts;
+            }
+            const int n = steps - from;
+            std::printf("%10d %10s %12.1f %14.5f %14.5f %12.3f %10.0f\n", iterations, "on", rate, residual / n, strain,
+                energy / n, contacts / n);
+        }
+    }
+}
+
+struct Bench {
+    const char* name;
+    void (*run)();
+};
+
+const Bench benches[] = {
+    { "layout", benchLayout },
+    { "solver", benchSolver },
+    { "backend", benchBackend },
+    { "volume", benchVolume },
+    { "stability", benchStability },
+    { "colliders", benchColliders },
+    { "sdf", benchSdf },
+    { "world", benchWorld },
+    { "scheduler", benchScheduler },
+    { "suballoc", benchSuballoc },
+    { "frustum", benchFrustum },
+    { "clusters", benchClusters },
+    { "raycast", benchRaycast },
+    { "telemetry", benchTelemetry },
+};
+
+} // namespace
+
+int RunBenchmarks(int argc, char** argv)
+{
+    int ran = 0;
+    for (const Bench& b : benches) {
+        bool selected = argc == 0;
+        for (int i = 0; i < argc; ++i) selected |= std::strcmp(argv[i], b.name) == 0;
+        if (!selected) continue;
+        b.run();
+        ++ran;
+    }
+    if (ran == 0) {
+        std::printf("unknown benchmark; available:");
+        for (const Bench& b : benches) std::printf(" %s", b.name);
+        std::printf("\n");
+        return 1;
+    }
+    if (failures) std::printf("\n%d check(s) FAILED\n", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,6 @@
+#pragma once
+
+// Headless micro-benchmarks for the simulation, run with
+//   YoutubeOpenGL.exe --bench [name ...]
+// No window or GL context is created. With no names every benchmark runs.
+int RunBenchmarks(int argc, char** argv);
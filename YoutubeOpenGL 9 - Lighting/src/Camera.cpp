@@ -22,6 +22,7 @@ void Camera::updateMatrix(float FOVdeg, float nearPlane, float farPlane)
 
 	// Sets new camera matrix
 	cameraMatrix = projection * view;
+	viewMatrix = view;
 }
 
 void Camera::Matrix(Shader& shader, const char* uniform)
@@ -0,0 +1,158 @@
+#include "ClusteredLights.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+int clampIndex(float v, int n)
+{
+    return std::min(std::max((int)std::floor(v), 0), n - 1);
+}
+
+} // namespace
+
+void LightClusters::bin(const std::vector<PointLight>& lights, const glm::mat4& view, float fovDeg, float aspect,
+    float nearPlane, float sliceFar)
+{
+    const float tanHalf = std::tan(0.5f * fovDeg * 3.14159265f / 180.0f);
+    const float scaleX = 1.0f / (tanHalf * aspect), scaleY = 1.0f / tanHalf;
+    depthScale_.x = (float)slices / std::log(sliceFar / nearPlane);
+    depthScale_.y = -std::log(nearPlane) * depthScale_.x;
+
+    // the range of one view-space interval [lo, hi] over depths [dNear, dFar] after the
+    // perspective divide, as tile indices (the extremes sit at the box corners)
+    auto tiles = [](float lo, float hi, float dNear, float dFar, float scale, int n, int& first, int& last) {
+        const float a = scale * (lo >= 0.0f ? lo / dFar : lo / dNear);
+        const float b = scale * (hi >= 0.0f ? hi / dNear : hi / dFar);
+        if (a > 1.0f || b < -1.0f) return false;
+        first = clampIndex((a * 0.5f + 0.5f) * n, n);
+        last = clampIndex((b * 0.5f + 0.5f) * n, n);
+        return true;
+    };
+
+    // slices first, then per slice the tiles the sphere's part in that slab projects into
+    // (its bounding box there, so a light can still be listed where it only reaches a
+    // cluster's corner). The spans are kept for the fill pass.
+    spans.clear();
+    lightSpans.assign(lights.size() + 1, 0);
+    for (size_t i = 0; i < lights.size(); ++i) {
+        lightSpans[i] = (uint32_t)spans.size();
+        const PointLight& l = lights[i];
+        const glm::vec3 v = glm::vec3(view * glm::vec4(l.position, 1.0f));
+        const float depth = -v.z, r = l.radius;
+        if (depth + r < nearPlane) continue;
+        const int z0 = clampIndex(std::log(std::max(depth - r, nearPlane)) * depthScale_.x + depthScale_.y, slices);
+        const int z1 = clampIndex(std::log(depth + r) * depthScale_.x + depthScale_.y, slices);
+        for (int z = z0; z <= z1; ++z) {
+            // the slab of this slice within the sphere's depth range
+            const float dNear = std::max({ depth - r, nearPlane, std::exp((z - depthScale_.y) / depthScale_.x) });
+            const float dFar = z == slices - 1 ? depth + r : std::min(depth + r, std::exp((z + 1 - depthScale_.y) / depthScale_.x));
+            if (dNear > dFar) continue;
+            // the sphere's widest cross-section inside the slab
+            const float dz = depth < dNear ? dNear - depth : (depth > dFar ? depth - dFar : 0.0f);
+            const float rz = std::sqrt(std::max(r * r - dz * dz, 0.0f));
+            Span sp;
+            sp.z = z;
+            if (!tiles(v.x - rz, v.x + rz, dNear, dFar, scaleX, tilesX, sp.x0, sp.x1)) continue;
+            if (!tiles(v.y - rz, v.y + rz, dNear, dFar, scaleY, tilesY, sp.y0, sp.y1)) continue;
+            spans.push_back(sp);
+        }
+    }
+    lightSpans[lights.size()] = (uint32_t)spans.size();
+
+    counts.assign(clusterCount, 0);
+    for (const Span& sp : spans)
+        for (int y = sp.y0; y <= sp.y1; ++y)
+            for (int x = sp.x0; x <= sp.x1; ++x) ++counts[(sp.z * tilesY + y) * tilesX + x];
+
+    // counts -> (first, count), then each cluster's indices in light order
+    ranges.resize(2 * clusterCount);
+    uint32_t total = 0;
+    for (int c = 0; c < clusterCount; ++c) {
+        ranges[2 * c] = total;
+        ranges[2 * c + 1] = counts[c];
+        total += counts[c];
+        counts[c] = ranges[2 * c];   // now the fill cursor
+    }
+    indices.resize(total);
+    for (size_t i = 0; i < lights.size(); ++i)
+        for (uint32_t k = lightSpans[i]; k < lightSpans[i + 1]; ++k) {
+            const Span& sp = spans[k];
+            for (int y = sp.y0; y <= sp.y1; ++y)
+                for (int x = sp.x0; x <= sp.x1; ++x) indices[counts[(sp.z * tilesY + y) * tilesX + x]++] = (uint32_t)i;
+        }
+}
+
+ClusteredLights::ClusteredLights()
+{
+    for (Stream* s : { &lightStream, &clusterStream, &indexStream }) {
+        glGenBuffers(1, &s->buffer);
+        glGenTextures(1, &s->texture);
+    }
+}
+
+ClusteredLights::~ClusteredLights()
+{
+    for (Stream* s : { &lightStream, &clusterStream, &indexStream }) {
+        glDeleteTextures(1, &s->texture);
+        glDeleteBuffers(1, &s->buffer);
+    }
+}
+
+void ClusteredLights::update(const std::vector<PointLight>& lights, const glm::mat4& view, float fovDeg, float aspect,
+    float nearPlane, float sliceFar)
+{
+    grid.bin(lights, view, fovDeg, aspect, nearPlane, sliceFar);
+
+    packed.resize(2 * lights.size());
+    for (size_t i = 0; i < lights.size(); ++i) {
+        packed[2 * i] = glm::vec4(lights[i].position, lights[i].radius);
+        packed[2 * i + 1] = glm::vec4(lights[i].color, 0.0f);
+    }
+    upload(lightStream, GL_RGBA32F, packed.data(), (GLsizeiptr)(packed.size() * sizeof(glm::vec4)));
+    upload(clusterStream, GL_RG32UI, grid.ranges.data(), (GLsizeiptr)(grid.ranges.size() * sizeof(uint32_t)));
+    upload(indexStream, GL_R32UI, grid.indices.data(), (GLsizeiptr)(grid.indices.size() * sizeof(uint32_t)));
+    uploadedLights = lights.size();
+}
+
+void ClusteredLights::upload(Stream& stream, GLenum format, const void* data, GLsizeiptr bytes)
+{
+    glBindBuffer(GL_TEXTURE_BUFFER, stream.buffer);
+    if (bytes > stream.capacity || stream.capacity == 0) {
+        // grow geometrically and re-attach, so the texture sees the new size
+        stream.capacity = std::max<GLsizeiptr>(std::max<GLsizeiptr>(bytes, 2 * stream.capacity), 256);
+        glBufferData(GL_TEXTURE_BUFFER, stream.capacity, nullptr, GL_STREAM_DRAW);
+        glBindTexture(GL_TEXTURE_BUFFER, stream.texture);
+        glTexBuffer(GL_TEXTURE_BUFFER, format, stream.buffer);
+        glBindTexture(GL_TEXTURE_BUFFER, 0);
+    }
+    else {
+        // orphan last frame's contents rather than wait for draws still reading them
+        glBufferData(GL_TEXTURE_BUFFER, stream.capacity, nullptr, GL_STREAM_DRAW);
+    }
+    if (bytes > 0) glBufferSubData(GL_TEXTURE_BUFFER, 0, bytes, data);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}
+
+void ClusteredLights::Bind()
+{
+    const GLint units[] = { lightTextureUnit, clusterTextureUnit, indexTextureUnit };
+    const GLuint textures[] = { lightStream.texture, clusterStream.texture, indexStream.texture };
+    for (int i = 0; i < 3; ++i) {
+        glActiveTexture(GL_TEXTURE0 + units[i]);
+        glBindTexture(GL_TEXTURE_BUFFER, textures[i]);
+    }
+    glActiveTexture(GL_TEXTURE0);
+}
+
+void ClusteredLights::setUniforms(GLuint program, int viewportWidth, int viewportHeight) const
+{
+    glUniform1i(glGetUniformLocation(program, "pointLights"), lightTextureUnit);
+    glUniform1i(glGetUniformLocation(program, "lightClusters"), clusterTextureUnit);
+    glUniform1i(glGetUniformLocation(program, "lightIndices"), indexTextureUnit);
+    glUniform3i(glGetUniformLocation(program, "clusterCount"), LightClusters::tilesX, LightClusters::tilesY, LightClusters::slices);
+    glUniform2f(glGetUniformLocation(program, "clusterTileScale"),
+        (float)LightClusters::tilesX / viewportWidth, (float)LightClusters::tilesY / viewportHeight);
+    const glm::vec2 depth = grid.depthScale();
+    glUniform2f(glGetUniformLocation(program, "clusterDepthScale"), depth.x, depth.y);
+}
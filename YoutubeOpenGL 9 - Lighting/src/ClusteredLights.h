@@ -0,0 +1,82 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+// A point light with a finite reach: its contribution falls to zero at `radius`.
+struct PointLight {
+    glm::vec3 position;
+    float radius;
+    glm::vec3 color;   // already scaled by intensity
+};
+
+// The view frustum cut into tilesX x tilesY screen tiles and `slices` depth slices
+// (exponentially spaced, so clusters stay roughly cubic with distance), and for each cluster
+// the lights whose sphere may reach into it. Pure CPU, rebuilt every frame.
+class LightClusters {
+public:
+    static constexpr int tilesX = 16, tilesY = 16, slices = 24;
+    static constexpr int clusterCount = tilesX * tilesY * slices;
+
+    // view: world -> view space (the camera looks down -z); the projection is a symmetric
+    // perspective like Camera::updateMatrix's. The slices span nearPlane..sliceFar, which
+    // is best kept to the depth the lit scene actually has (everything further shares the
+    // last slice) rather than the camera's far plane.
+    void bin(const std::vector<PointLight>& lights, const glm::mat4& view, float fovDeg, float aspect,
+        float nearPlane, float sliceFar);
+
+    // slice = log(view depth) * depthScale.x + depthScale.y (what default.frag computes)
+    glm::vec2 depthScale() const { return depthScale_; }
+
+    // per cluster (x fastest, then y, then slice): first entry in `indices` and light count
+    std::vector<uint32_t> ranges;   // 2 per cluster
+    std::vector<uint32_t> indices;  // into the light list given to bin()
+
+private:
+    struct Span { int z, x0, x1, y0, y1; };   // one slice's tiles a light reaches
+    std::vector<Span> spans;
+    std::vector<uint32_t> lightSpans;   // light i: spans[lightSpans[i] .. lightSpans[i + 1])
+    std::vector<uint32_t> counts;
+    glm::vec2 depthScale_ = glm::vec2(0.0f);
+};
+
+// A light list and its clusters in texture buffers, for the fragment shader to loop over only
+// the lights of the cluster a fragment is in (GL 3.3 has no storage buffers):
+// "pointLights" RGBA32F, 2 texels per light (position + radius, color);
+// "lightClusters" RG32UI (first, count) per cluster; "lightIndices" R32UI.
+class ClusteredLights {
+public:
+    static constexpr GLint lightTextureUnit = 4;
+    static constexpr GLint clusterTextureUnit = 5;
+    static constexpr GLint indexTextureUnit = 6;
+
+    ClusteredLights();
+    ~ClusteredLights();
+    ClusteredLights(const ClusteredLights&) = delete;
+    ClusteredLights& operator=(const ClusteredLights&) = delete;
+
+    // bins the lights and uploads the list and the clusters
+    void update(const std::vector<PointLight>& lights, const glm::mat4& view, float fovDeg, float aspect,
+        float nearPlane, float sliceFar);
+    void Bind();   // the three texture buffers on their units
+
+    // sets the samplers and the cluster uniforms of a program using default.frag (call after
+    // update; the program must be active)
+    void setUniforms(GLuint program, int viewportWidth, int viewportHeight) const;
+
+    const LightClusters& clusters() const { return grid; }
+    size_t lightCount() const { return uploadedLights; }
+
+private:
+    struct Stream {
+        GLuint buffer = 0, texture = 0;
+        GLsizeiptr capacity = 0;
+    };
+    void upload(Stream& stream, GLenum format, const void* data, GLsizeiptr bytes);
+
+    LightClusters grid;
+    Stream lightStream, clusterStream, indexStream;
+    std::vector<glm::vec4> packed;   // upload scratch
+    size_t uploadedLights = 0;
+};
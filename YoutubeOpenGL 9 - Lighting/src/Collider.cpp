@@ -0,0 +1,428 @@
+#include "Collider.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+using HalfSpace = ColliderSet::HalfSpace;
+using Box = ColliderSet::Box;
+using Sphere = ColliderSet::Sphere;
+using Capsule = ColliderSet::Capsule;
+using HeightField = ColliderSet::HeightField;
+using Mesh = ColliderSet::Mesh;
+
+const float EPS = 1e-4f; // particles are left this far outside a surface
+
+// Per-thread scratch for the batched passes, so bodies can step on several threads.
+std::vector<float>& distanceScratch(size_t n)
+{
+    thread_local std::vector<float> d;
+    if (d.size() < n) d.resize(n);
+    return d;
+}
+
+// Particle positions as separate coordinate arrays (like BoxList), so the per-collider
+// distance loops run over plain floats and vectorize. Gathered once per call, before the
+// first collider that survives the broad phase, and kept current as handlers move particles.
+struct Positions {
+    std::vector<float> x, y, z;
+
+    void gather(const std::vector<Particle>& particles)
+    {
+        const size_t n = particles.size();
+        x.resize(n);
+        y.resize(n);
+        z.resize(n);
+        for (size_t i = 0; i < n; ++i) {
+            x[i] = particles[i].p.x;
+            y[i] = particles[i].p.y;
+            z[i] = particles[i].p.z;
+        }
+    }
+    void refresh(const std::vector<Particle>& particles, int i)
+    {
+        x[i] = particles[i].p.x;
+        y[i] = particles[i].p.y;
+        z[i] = particles[i].p.z;
+    }
+    glm::vec3 operator[](size_t i) const { return glm::vec3(x[i], y[i], z[i]); }
+};
+
+Positions& positionScratch()
+{
+    thread_local Positions positions;
+    return positions;
+}
+
+bool overlaps(const glm::vec3& aMin, const glm::vec3& aMax, const glm::vec3& bMin, const glm::vec3& bMax)
+{
+    return aMin.x <= bMax.x && bMin.x <= aMax.x &&
+        aMin.y <= bMax.y && bMin.y <= aMax.y &&
+        aMin.z <= bMax.z && bMin.z <= aMax.z;
+}
+
+// signed distance of the box corner deepest into the half-space's outside
+float lowestCorner(const HalfSpace& h, const glm::vec3& bMin, const glm::vec3& bMax)
+{
+    const glm::vec3 c(h.normal.x >= 0.0f ? bMin.x : bMax.x, h.normal.y >= 0.0f ? bMin.y : bMax.y,
+        h.normal.z >= 0.0f ? bMin.z : bMax.z);
+    return glm::dot(h.normal, c) - h.offset;
+}
+
+glm::vec3 reflect(const glm::vec3& v, const glm::vec3& n, const ColliderMaterial& m)
+{
+    const float vn = glm::dot(v, n);
+    const glm::vec3 vt = v - vn * n;
+    return vt * (1.0f - m.friction) - vn * n * (1.0f - m.restitution);
+}
+
+// ---- signed distance (negative inside the solid) and outward normal per shape; spheres,
+// capsules and boxes only have their batched distances below ----
+
+glm::vec3 normal(const Sphere& s, const glm::vec3& x)
+{
+    const glm::vec3 d = x - s.center;
+    const float len = glm::length(d);
+    return len > 1e-8f ? d / len : glm::vec3(0, 1, 0);
+}
+
+glm::vec3 closestOnSegment(const glm::vec3& a, const glm::vec3& b, const glm::vec3& x)
+{
+    const glm::vec3 ab = b - a;
+    const float t = glm::dot(x - a, ab) / std::max(glm::dot(ab, ab), 1e-12f);
+    return a + std::max(0.0f, std::min(1.0f, t)) * ab;
+}
+
+glm::vec3 normal(const Capsule& c, const glm::vec3& x)
+{
+    const glm::vec3 d = x - closestOnSegment(c.a, c.b, x);
+    const float len = glm::length(d);
+    return len > 1e-8f ? d / len : glm::vec3(0, 1, 0);
+}
+
+glm::vec3 normal(const Box& b, const glm::vec3& x)
+{
+    const glm::vec3 local = glm::transpose(b.rotation) * (x - b.center);
+    const glm::vec3 q = glm::abs(local) - b.half;
+    const glm::vec3 s(local.x < 0.0f ? -1.0f : 1.0f, local.y < 0.0f ? -1.0f : 1.0f, local.z < 0.0f ? -1.0f : 1.0f);
+    glm::vec3 n(0.0f);
+    if (q.x > 0.0f || q.y > 0.0f || q.z > 0.0f) {
+        n = glm::normalize(glm::max(q, glm::vec3(0.0f)) * s);
+    }
+    else {
+        // inside: out through the nearest face
+        const int axis = (q.x >= q.y && q.x >= q.z) ? 0 : (q.y >= q.z ? 1 : 2);
+        n[axis] = s[axis];
+    }
+    return b.rotation * n;
+}
+
+// Bilinear height (above origin.y) and slope at (x, z); false outside the grid.
+bool sampleHeight(const HeightField& hf, float x, float z, float& h, glm::vec2& slope)
+{
+    const float gx = (x - hf.origin.x) / hf.cellSize;
+    const float gz = (z - hf.origin.z) / hf.cellSize;
+    if (!(gx >= 0.0f && gz >= 0.0f && gx <= (float)(hf.cols - 1) && gz <= (float)(hf.rows - 1))) return false;
+
+    const int i = std::min((int)gx, hf.cols - 2);
+    const int k = std::min((int)gz, hf.rows - 2);
+    const float fx = gx - (float)i, fz = gz - (float)k;
+    const float h00 = hf.heights[k * hf.cols + i], h10 = hf.heights[k * hf.cols + i + 1];
+    const float h01 = hf.heights[(k + 1) * hf.cols + i], h11 = hf.heights[(k + 1) * hf.cols + i + 1];
+    h = (h00 * (1.0f - fx) + h10 * fx) * (1.0f - fz) + (h01 * (1.0f - fx) + h11 * fx) * fz;
+    slope.x = ((h10 - h00) * (1.0f - fz) + (h11 - h01) * fz) / hf.cellSize;
+    slope.y = ((h01 - h00) * (1.0f - fx) + (h11 - h10) * fx) / hf.cellSize;
+    return true;
+}
+
+// vertical gap scaled onto the surface normal (exact on flat cells)
+float distance(const HeightField& hf, const glm::vec3& x)
+{
+    float h;
+    glm::vec2 slope;
+    if (!sampleHeight(hf, x.x, x.z, h, slope)) return std::numeric_limits<float>::max();
+    return (x.y - hf.origin.y - h) / std::sqrt(1.0f + glm::dot(slope, slope));
+}
+
+glm::vec3 normal(const HeightField& hf, const glm::vec3& x)
+{
+    float h;
+    glm::vec2 slope;
+    if (!sampleHeight(hf, x.x, x.z, h, slope)) return glm::vec3(0, 1, 0);
+    return glm::normalize(glm::vec3(-slope.x, 1.0f, -slope.y));
+}
+
+// trilinear lookup in the mesh's frame (rigid, so distances carry over unchanged)
+float distance(const Mesh& m, const glm::vec3& x) { return m.sdf->distance(glm::transpose(m.rotation) * (x - m.position)); }
+
+glm::vec3 normal(const Mesh& m, const glm::vec3& x)
+{
+    glm::vec3 g;
+    m.sdf->sample(glm::transpose(m.rotation) * (x - m.position), &g);
+    const float len = glm::length(g);
+    return len > 1e-8f ? m.rotation * (g / len) : glm::vec3(0, 1, 0);
+}
+
+// ---- the same distances over a whole body at once ----
+
+// Shapes with a lookup (height fields, meshes) gather from a grid per particle and gain
+// nothing from the batch; they go through the scalar distance.
+template <class Shape>
+void distances(const Shape& shape, const Positions& P, size_t n, float* out)
+{
+    for (size_t i = 0; i < n; ++i) out[i] = distance(shape, P[i]);
+}
+
+void distances(const Sphere& s, const Positions& P, size_t n, float* out)
+{
+    const float* X = P.x.data(); const float* Y = P.y.data(); const float* Z = P.z.data();
+    const float cx = s.center.x, cy = s.center.y, cz = s.center.z, r = s.radius;
+    for (size_t i = 0; i < n; ++i) {
+        const float dx = X[i] - cx, dy = Y[i] - cy, dz = Z[i] - cz;
+        out[i] = std::sqrt(dx * dx + dy * dy + dz * dz) - r;
+    }
+}
+
+void distances(const Capsule& c, const Positions& P, size_t n, float* out)
+{
+    const float* X = P.x.data(); const float* Y = P.y.data(); const float* Z = P.z.data();
+    const glm::vec3 ab = c.b - c.a;
+    const float invLen2 = 1.0f / std::max(glm::dot(ab, ab), 1e-12f);
+    const float ax0 = c.a.x, ay0 = c.a.y, az0 = c.a.z, abx = ab.x, aby = ab.y, abz = ab.z, r = c.radius;
+    for (size_t i = 0; i < n; ++i) {
+        const float ax = X[i] - ax0, ay = Y[i] - ay0, az = Z[i] - az0;
+        const float t = std::max(0.0f, std::min(1.0f, (ax * abx + ay * aby + az * abz) * invLen2));
+        const float dx = ax - t * abx, dy = ay - t * aby, dz = az - t * abz;
+        out[i] = std::sqrt(dx * dx + dy * dy + dz * dz) - r;
+    }
+}
+
+void distances(const Box& b, const Positions& P, size_t n, float* out)
+{
+    const float* X = P.x.data(); const float* Y = P.y.data(); const float* Z = P.z.data();
+    // local = R^T (x - center): a dot with each column of the rotation (u, v, w)
+    const glm::vec3 u = b.rotation[0], v = b.rotation[1], w = b.rotation[2];
+    const float ux = u.x, uy = u.y, uz = u.z, vx = v.x, vy = v.y, vz = v.z, wx = w.x, wy = w.y, wz = w.z;
+    const float cx = b.center.x, cy = b.center.y, cz = b.center.z, hx = b.half.x, hy = b.half.y, hz = b.half.z;
+    for (size_t i = 0; i < n; ++i) {
+        const float dx = X[i] - cx, dy = Y[i] - cy, dz = Z[i] - cz;
+        const float qx = std::fabs(ux * dx + uy * dy + uz * dz) - hx;
+        const float qy = std::fabs(vx * dx + vy * dy + vz * dz) - hy;
+        const float qz = std::fabs(wx * dx + wy * dy + wz * dz) - hz;
+        const float ox = std::max(qx, 0.0f), oy = std::max(qy, 0.0f), oz = std::max(qz, 0.0f);
+        out[i] = std::sqrt(ox * ox + oy * oy + oz * oz) + std::min(std::max(qx, std::max(qy, qz)), 0.0f);
+    }
+}
+
+// ---- world bounds per shape, for the broad phase ----
+
+void bounds(const Sphere& s, glm::vec3& mn, glm::vec3& mx) { mn = s.center - s.radius; mx = s.center + s.radius; }
+void bounds(const Capsule& c, glm::vec3& mn, glm::vec3& mx)
+{
+    mn = glm::min(c.a, c.b) - c.radius;
+    mx = glm::max(c.a, c.b) + c.radius;
+}
+void bounds(const Box& b, glm::vec3& mn, glm::vec3& mx) { mn = b.boundsMin; mx = b.boundsMax; }
+void bounds(const HeightField& hf, glm::vec3& mn, glm::vec3& mx) { mn = hf.boundsMin; mx = hf.boundsMax; }
+void bounds(const Mesh& m, glm::vec3& mn, glm::vec3& mx) { mn = m.boundsMin; mx = m.boundsMax; }
+
+// One collider against every particle: a tight distance loop over the coordinate arrays
+// first, then the handler for the (usually few) particles within the margin. A handler may
+// move its particle, so the arrays are brought up to date for the colliders after this one.
+template <class Shape, class Handler>
+void solidPass(const Shape& shape, const std::vector<Particle>& particles, Positions& P, float margin,
+    Handler& handler)
+{
+    const size_t n = particles.size();
+    std::vector<float>& dist = distanceScratch(n);
+    distances(shape, P, n, dist.data());
+    for (size_t i = 0; i < n; ++i) {
+        if (dist[i] >= margin) continue;
+        handler((int)i, dist[i], normal(shape, P[i]), shape.material);
+        P.refresh(particles, (int)i);
+    }
+}
+
+template <class Shape, class Handler>
+void solidPasses(const std::vector<Shape>& shapes, bool cull, const std::vector<Particle>& particles,
+    Positions& P, bool& gathered, const glm::vec3& boundsMin, const glm::vec3& boundsMax, float margin,
+    Handler& handler)
+{
+    for (const Shape& shape : shapes) {
+        glm::vec3 mn, mx;
+        bounds(shape, mn, mx);
+        if (cull && !overlaps(mn - margin, mx + margin, boundsMin, boundsMax)) continue;
+        if (!gathered) {
+            P.gather(particles);
+            gathered = true;
+        }
+        solidPass(shape, particles, P, margin, handler);
+    }
+}
+
+} // namespace
+
+ColliderSet::ColliderSet(const Container& box)
+{
+    const ColliderMaterial m{ box.restitution, box.friction };
+    // walls: x in [min.x, max.x], z in [min.z, max.z], y >= min.y (floor), open top
+    addHalfSpace(glm::vec3(0, 1, 0), box.min.y, m);
+    addHalfSpace(glm::vec3(1, 0, 0), box.min.x, m);
+    addHalfSpace(glm::vec3(-1, 0, 0), -box.max.x, m);
+    addHalfSpace(glm::vec3(0, 0, 1), box.min.z, m);
+    addHalfSpace(glm::vec3(0, 0, -1), -box.max.z, m);
+}
+
+void ColliderSet::addHalfSpace(glm::vec3 normal, float offset, ColliderMaterial material)
+{
+    const float len = glm::length(normal);
+    halfSpaces.push_back({ normal / len, offset / len, material });
+}
+
+void ColliderSet::addBox(glm::vec3 center, glm::vec3 halfExtents, const glm::mat3& rotation, ColliderMaterial material)
+{
+    Box b{ center, halfExtents, rotation, material, glm::vec3(0.0f), glm::vec3(0.0f) };
+    glm::vec3 extent(0.0f);
+    for (int c = 0; c < 3; ++c) extent += glm::abs(rotation[c]) * halfExtents[c];
+    b.boundsMin = center - extent;
+    b.boundsMax = center + extent;
+    boxes.push_back(b);
+}
+
+void ColliderSet::addSphere(glm::vec3 center, float radius, ColliderMaterial material)
+{
+    spheres.push_back({ center, radius, material });
+}
+
+void ColliderSet::addCapsule(glm::vec3 a, glm::vec3 b, float radius, ColliderMaterial material)
+{
+    capsules.push_back({ a, b, radius, material });
+}
+
+void ColliderSet::addHeightField(glm::vec3 origin, float cellSize, int cols, int rows, std::vector<float> heights,
+    ColliderMaterial material)
+{
+    if (cols < 2 || rows < 2 || (int)heights.size() != cols * rows) return;
+    HeightField hf{ origin, cellSize, cols, rows, std::move(heights), material, glm::vec3(0.0f), glm::vec3(0.0f) };
+    const auto range = std::minmax_element(hf.heights.begin(), hf.heights.end());
+    hf.boundsMin = glm::vec3(origin.x, origin.y + *range.first, origin.z);
+    hf.boundsMax = glm::vec3(origin.x + cellSize * (cols - 1), origin.y + *range.second, origin.z + cellSize * (rows - 1));
+    heightFields.push_back(std::move(hf));
+}
+
+void ColliderSet::addMesh(std::shared_ptr<const SignedDistanceField> sdf, glm::vec3 position, const glm::mat3& rotation,
+    ColliderMaterial material)
+{
+    if (!sdf) return;
+    // the field's grid box in world space
+    const glm::vec3 center = 0.5f * (sdf->boundsMin() + sdf->boundsMax());
+    const glm::vec3 half = 0.5f * (sdf->boundsMax() - sdf->boundsMin());
+    glm::vec3 extent(0.0f);
+    for (int c = 0; c < 3; ++c) extent += glm::abs(rotation[c]) * half[c];
+    const glm::vec3 worldCenter = rotation * center + position;
+    meshes.push_back({ std::move(sdf), position, rotation, material, worldCenter - extent, worldCenter + extent });
+}
+
+template <class Handler>
+void ColliderSet::forEachSolidContact(const std::vector<Particle>& particles, const glm::vec3& boundsMin,
+    const glm::vec3& boundsMax, float margin, Handler&& handler) const
+{
+    // no gather at all when the broad phase rejects every solid (the common case)
+    Positions& P = positionScratch();
+    bool gathered = false;
+    solidPasses(boxes, cullAgainstBounds, particles, P, gathered, boundsMin, boundsMax, margin, handler);
+    solidPasses(spheres, cullAgainstBounds, particles, P, gathered, boundsMin, boundsMax, margin, handler);
+    solidPasses(capsules, cullAgainstBounds, particles, P, gathered, boundsMin, boundsMax, margin, handler);
+    solidPasses(heightFields, cullAgainstBounds, particles, P, gathered, boundsMin, boundsMax, margin, handler);
+    solidPasses(meshes, cullAgainstBounds, particles, P, gathered, boundsMin, boundsMax, margin, handler);
+}
+
+void ColliderSet::collide(std::vector<Particle>& particles, const glm::vec3& boundsMin, const glm::vec3& boundsMax) const
+{
+    const size_t n = particles.size();
+
+    // Half-spaces, swept: the earliest plane each particle crosses on its way prev -> p. It
+    // stops there (time of impact) instead of wherever it ended up, and bounces.
+    thread_local std::vector<const HalfSpace*> planes;
+    planes.clear();
+    for (const HalfSpace& h : halfSpaces)
+        if (!cullAgainstBounds || lowestCorner(h, boundsMin, boundsMax) < EPS) planes.push_back(&h);
+
+    if (!planes.empty()) {
+        thread_local std::vector<int> hit;
+        std::vector<float>& toi = distanceScratch(n);
+        hit.assign(n, -1);
+        for (int k = 0; k < (int)planes.size(); ++k) {
+            const HalfSpace& h = *planes[k];
+            for (size_t i = 0; i < n; ++i) {
+                const float d1 = glm::dot(h.normal, particles[i].p) - h.offset;
+                if (d1 >= 0.0f) continue; // ends inside
+                const float d0 = glm::dot(h.normal, particles[i].prev) - h.offset;
+                const float t = d0 > 0.0f ? d0 / (d0 - d1) : 0.0f; // already out: hit at once
+                if (hit[i] < 0 || t < toi[i]) { toi[i] = t; hit[i] = k; }
+            }
+        }
+
+        for (size_t i = 0; i < n; ++i) {
+            if (hit[i] < 0) continue;
+            Particle& p = particles[i];
+            const HalfSpace& h = *planes[hit[i]];
+            const glm::vec3 move = p.p - p.prev;
+            glm::vec3 cur = p.prev + move * toi[i];
+            cur += h.normal * (h.offset + EPS - glm::dot(h.normal, cur));
+            const glm::vec3 v = reflect(move, h.normal, h.material);
+
+            // a particle that started outside may still be past another plane
+            for (const HalfSpace* other : planes) {
+                const float d = glm::dot(other->normal, cur) - other->offset;
+                if (d < EPS) cur += other->normal * (EPS - d);
+            }
+            p.p = cur;
+            p.prev = cur - v;
+        }
+    }
+
+    // Solids: push out along the surface normal and reflect the incoming velocity.
+    auto respond = [&](int i, float dist, const glm::vec3& nrm, const ColliderMaterial& m) {
+        Particle& p = particles[i];
+        glm::vec3 v = p.p - p.prev;
+        if (glm::dot(v, nrm) < 0.0f) v = reflect(v, nrm, m);
+        p.p += nrm * (EPS - dist);
+        p.prev = p.p - v;
+        };
+    forEachSolidContact(particles, boundsMin, boundsMax, 0.0f, respond);
+}
+
+void ColliderSet::project(std::vector<Particle>& particles, const glm::vec3& boundsMin, const glm::vec3& boundsMax) const
+{
+    for (const HalfSpace& h : halfSpaces) {
+        if (cullAgainstBounds && lowestCorner(h, boundsMin, boundsMax) >= EPS) continue;
+        for (auto& p : particles) {
+            const float d = glm::dot(h.normal, p.p) - h.offset;
+            if (d < EPS) p.p += h.normal * (EPS - d);
+        }
+    }
+
+    auto pushOut = [&](int i, float dist, const glm::vec3& nrm, const ColliderMaterial&) {
+        particles[i].p += nrm * (EPS - dist);
+        };
+    forEachSolidContact(particles, boundsMin, boundsMax, 0.0f, pushOut);
+}
+
+void ColliderSet::findContacts(const std::vector<Particle>& particles, const glm::vec3& boundsMin,
+    const glm::vec3& boundsMax, float margin, std::vector<ColliderContact>& out) const
+{
+    for (const HalfSpace& h : halfSpaces) {
+        if (cullAgainstBounds && lowestCorner(h, boundsMin, boundsMax) >= margin) continue;
+        for (size_t i = 0; i < particles.size(); ++i) {
+            const float d = glm::dot(h.normal, particles[i].p) - h.offset;
+            if (d < margin) out.push_back({ (int)i, h.normal, -d });
+        }
+    }
+
+    auto record = [&](int i, float dist, const glm::vec3& nrm, const ColliderMaterial&) {
+        out.push_back({ i, nrm, -dist });
+        };
+    forEachSolidContact(particles, boundsMin, boundsMax, margin, record);
+}
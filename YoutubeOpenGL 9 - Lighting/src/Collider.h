@@ -0,0 +1,112 @@
+#pragma once
+#include <memory>
+#include <vector>
+#include <glm/glm.hpp>
+#include "Particle.h"
+#include "SignedDistanceField.h"
+
+struct Container {
+    glm::vec3 min;   // floor corner
+    glm::vec3 max;   // opposite top corner (open top means we only use min.y as floor, max.y for wall height check)
+    float restitution = 0.25f;   // bounciness
+    float friction = 0.6f;
+};
+
+// Response of one collider. As with Container, a bounce scales the normal velocity by
+// (1 - restitution) and the tangential velocity by (1 - friction).
+struct ColliderMaterial {
+    float restitution = 0.25f;
+    float friction = 0.6f;
+};
+
+// A particle within `margin` of a collider surface (see ColliderSet::findContacts).
+struct ColliderContact {
+    int index;          // particle
+    glm::vec3 normal;   // unit, pointing out of the collider
+    float depth;        // how far the particle is inside (negative: still that far outside)
+};
+
+// The static world soft bodies collide with: half-spaces, oriented boxes, spheres, capsules,
+// height fields and baked triangle meshes, each with its own material. Every collider is
+// evaluated as one batched pass over a body's particles (a tight signed-distance loop, then
+// the few contacts), and colliders whose bounds miss the body's bounds are skipped entirely.
+class ColliderSet {
+public:
+    ColliderSet() = default;
+    // The old open-top box: floor plus four walls.
+    explicit ColliderSet(const Container& box);
+
+    // particles are kept where dot(normal, x) >= offset
+    void addHalfSpace(glm::vec3 normal, float offset, ColliderMaterial material = {});
+    // solid box; rotation's columns are the box axes in world space
+    void addBox(glm::vec3 center, glm::vec3 halfExtents, const glm::mat3& rotation = glm::mat3(1.0f),
+        ColliderMaterial material = {});
+    void addSphere(glm::vec3 center, float radius, ColliderMaterial material = {});
+    void addCapsule(glm::vec3 a, glm::vec3 b, float radius, ColliderMaterial material = {});
+    // heights[z * cols + x] sampled every cellSize from origin (x, z), on top of origin.y;
+    // particles are kept above the bilinear surface inside the grid
+    void addHeightField(glm::vec3 origin, float cellSize, int cols, int rows, std::vector<float> heights,
+        ColliderMaterial material = {});
+    // a static mesh baked into a distance field (see SignedDistanceField), placed rigidly:
+    // world = rotation * local + position. Fields can be shared between placements.
+    void addMesh(std::shared_ptr<const SignedDistanceField> sdf, glm::vec3 position,
+        const glm::mat3& rotation = glm::mat3(1.0f), ColliderMaterial material = {});
+
+    // Velocity response for one step: prev -> p is swept against the half-spaces (time of
+    // impact), and anything inside a solid is pushed out along its surface normal. Velocity
+    // is reflected with each collider's material; prev is rewritten to carry it.
+    // [boundsMin, boundsMax] must contain every particle's prev and p.
+    void collide(std::vector<Particle>& particles, const glm::vec3& boundsMin, const glm::vec3& boundsMax) const;
+
+    // Positions only: pushes particles out of every collider (between solver passes).
+    void project(std::vector<Particle>& particles, const glm::vec3& boundsMin, const glm::vec3& boundsMax) const;
+
+    // Appends every particle closer than margin to a collider surface.
+    void findContacts(const std::vector<Particle>& particles, const glm::vec3& boundsMin,
+        const glm::vec3& boundsMax, float margin, std::vector<ColliderContact>& out) const;
+
+    size_t size() const
+    {
+        return halfSpaces.size() + boxes.size() + spheres.size() + capsules.size() + heightFields.size() +
+            meshes.size();
+    }
+
+    // broad phase: skip colliders whose bounds miss the body's (off only for comparison)
+    bool cullAgainstBounds = true;
+
+    struct HalfSpace { glm::vec3 normal; float offset; ColliderMaterial material; };
+    struct Box {
+        glm::vec3 center, half;
+        glm::mat3 rotation;
+        ColliderMaterial material;
+        glm::vec3 boundsMin, boundsMax;
+    };
+    struct Sphere { glm::vec3 center; float radius; ColliderMaterial material; };
+    struct Capsule { glm::vec3 a, b; float radius; ColliderMaterial material; };
+    struct HeightField {
+        glm::vec3 origin;
+        float cellSize;
+        int cols, rows;
+        std::vector<float> heights;
+        ColliderMaterial material;
+        glm::vec3 boundsMin, boundsMax;
+    };
+    struct Mesh {
+        std::shared_ptr<const SignedDistanceField> sdf;
+        glm::vec3 position;
+        glm::mat3 rotation;
+        ColliderMaterial material;
+        glm::vec3 boundsMin, boundsMax;
+    };
+
+private:
+    std::vector<HalfSpace>   halfSpaces;
+    std::vector<Box>         boxes;
+    std::vector<Sphere>      spheres;
+    std::vector<Capsule>     capsules;
+    std::vector<HeightField> heightFields;
+    std::vector<Mesh>        meshes;
+
+    template <class Handler> void forEachSolidContact(const std::vector<Particle>& particles,
+        const glm::vec3& boundsMin, const glm::vec3& boundsMax, float margin, Handler&& handler) const;
+};
@@ -0,0 +1,35 @@
+#include "DynamicResolution.h"
+#include <algorithm>
+#include <cmath>
+
+DynamicResolution::DynamicResolution(double targetMs_, float minScale_, float maxScale_)
+    : targetMs(targetMs_), minScale(minScale_), maxScale(maxScale_), current(maxScale_)
+{
+}
+
+bool DynamicResolution::update(double gpuMs)
+{
+    if (wait > 0) {
+        --wait;
+        if (wait == 0) smoothed = 0.0;   // start over at the new scale
+        return false;
+    }
+    smoothed = smoothed == 0.0 ? gpuMs : 0.8 * smoothed + 0.2 * gpuMs;
+
+    // over budget: shrink; well under: grow; in between: leave it
+    if (smoothed <= targetMs && smoothed >= headroom * targetMs) return false;
+    const double aim = smoothed > targetMs ? targetMs : headroom * targetMs;
+    // pixels ~ scale^2; at most 15% per change so one bad frame cannot halve the resolution
+    const double step = std::clamp(std::sqrt(aim / std::max(smoothed, 1e-3)), 0.85, 1.15);
+    const float next = std::clamp((float)(current * step), minScale, maxScale);
+    if (std::fabs(next - current) < 0.01f) return false;
+    current = next;
+    wait = cooldown;
+    return true;
+}
+
+int DynamicResolution::size(int full) const
+{
+    const int scaled = (int)std::lround(full * current / 8.0) * 8;
+    return std::clamp(scaled, std::min(full, 8), full);
+}
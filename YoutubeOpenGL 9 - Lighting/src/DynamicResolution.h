@@ -0,0 +1,29 @@
+#pragma once
+
+// Picks the internal render scale (of the window's width and height) from measured GPU frame
+// times, to hold a target frame time: cost goes roughly with the pixel count, so the scale
+// moves by the square root of target / measured. Smoothed, with a dead band and a cooldown
+// while the frames rendered at the old scale are still being measured, so it settles
+// instead of hunting. No GL calls.
+class DynamicResolution {
+public:
+    explicit DynamicResolution(double targetMs, float minScale = 0.5f, float maxScale = 1.0f);
+
+    // one GPU frame time (GpuTimer::poll); true if the scale changed
+    bool update(double gpuMs);
+
+    float scale() const { return current; }
+    // a window dimension at the current scale, in steps of 8 pixels
+    int size(int full) const;
+    double smoothedMs() const { return smoothed; }
+
+    double targetMs;
+    float minScale, maxScale;
+    double headroom = 0.85;  // scale up only below this fraction of the target
+    int cooldown = 6;        // samples ignored after a change (still from the old scale)
+
+private:
+    float current;
+    double smoothed = 0.0;
+    int wait = 0;
+};
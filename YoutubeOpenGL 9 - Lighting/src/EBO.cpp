@@ -20,8 +20,33 @@ void EBO::Unbind()
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 }
 
+// Takes over the other's EBO, leaving it empty
+EBO::EBO(EBO&& other) noexcept
+	: ID(other.ID)
+{
+	other.ID = 0;
+}
+
+EBO& EBO::operator=(EBO&& other) noexcept
+{
+	if (this != &other)
+	{
+		Delete();
+		ID = other.ID;
+		other.ID = 0;
+	}
+	return *this;
+}
+
+EBO::~EBO()
+{
+	Delete();
+}
+
 // Deletes the EBO
 void EBO::Delete()
 {
+	if (ID == 0) return;
 	glDeleteBuffers(1, &ID);
+	ID = 0;
 }
\ No newline at end of file
@@ -7,15 +7,21 @@ class EBO
 {
 public:
 	// ID reference of Elements Buffer Object
-	GLuint ID;
+	GLuint ID = 0;
 	// Constructor that generates a Elements Buffer Object and links it to indices
 	EBO(GLuint* indices, GLsizeiptr size);
+	// Owns its buffer: move-only, and deleted with the EBO unless Delete() came first
+	EBO(EBO&& other) noexcept;
+	EBO& operator=(EBO&& other) noexcept;
+	EBO(const EBO&) = delete;
+	EBO& operator=(const EBO&) = delete;
+	~EBO();
 
 	// Binds the EBO
 	void Bind();
 	// Unbinds the EBO
 	void Unbind();
-	// Deletes the EBO
+	// Deletes the EBO (safe to call twice)
 	void Delete();
 };
 
@@ -0,0 +1,71 @@
+// Only the Projective Dynamics benchmark uses this (see SolverBackend in Jelly.h)
+#ifdef JELLY_BENCH_PD
+#include "EnvelopeCholesky.h"
+#include <algorithm>
+#include <cmath>
+
+bool EnvelopeCholesky::factor(int n_, const std::vector<Entry>& lower)
+{
+    n = n_;
+    first.assign(n, 0);
+    for (int i = 0; i < n; ++i) first[i] = i;
+    for (const auto& e : lower) first[e.row] = std::min(first[e.row], e.col);
+
+    rowStart.assign(n + 1, 0);
+    for (int i = 0; i < n; ++i) rowStart[i + 1] = rowStart[i] + (size_t)(i - first[i] + 1);
+    values.assign(rowStart[n], 0.0f);
+    for (const auto& e : lower) row(e.row)[e.col] += e.value;
+
+    // Row-by-row (bordering) factorization; row i only reads rows above it.
+    for (int i = 0; i < n; ++i) {
+        float* Li = row(i);
+        for (int j = first[i]; j < i; ++j) {
+            const float* Lj = row(j);
+            const int k0 = std::max(first[i], first[j]);
+            float sum = Li[j];
+            for (int k = k0; k < j; ++k) sum -= Li[k] * Lj[k];
+            Li[j] = sum / Lj[j];
+        }
+        float diag = Li[i];
+        for (int k = first[i]; k < i; ++k) diag -= Li[k] * Li[k];
+        if (!(diag > 0.0f)) return false;
+        Li[i] = std::sqrt(diag);
+    }
+    return true;
+}
+
+void EnvelopeCholesky::solve(glm::vec3* b) const
+{
+    // plain float accumulators over the interleaved xyz stream vectorize far better than
+    // glm::vec3 arithmetic in the inner loops
+    float* x = &b[0].x;
+
+    // forward: L y = b
+    for (int i = 0; i < n; ++i) {
+        const float* Li = row(i);
+        float sx = x[3 * i], sy = x[3 * i + 1], sz = x[3 * i + 2];
+        for (int k = first[i]; k < i; ++k) {
+            const float l = Li[k];
+            sx -= l * x[3 * k];
+            sy -= l * x[3 * k + 1];
+            sz -= l * x[3 * k + 2];
+        }
+        const float inv = 1.0f / Li[i];
+        x[3 * i] = sx * inv; x[3 * i + 1] = sy * inv; x[3 * i + 2] = sz * inv;
+    }
+    // backward: L^T x = y, scattering each solved x_i up its row
+    for (int i = n - 1; i >= 0; --i) {
+        const float* Li = row(i);
+        const float inv = 1.0f / Li[i];
+        const float xx = x[3 * i] * inv, xy = x[3 * i + 1] * inv, xz = x[3 * i + 2] * inv;
+        x[3 * i] = xx; x[3 * i + 1] = xy; x[3 * i + 2] = xz;
+        for (int k = first[i]; k < i; ++k) {
+            const float l = Li[k];
+            x[3 * k] -= l * xx;
+            x[3 * k + 1] -= l * xy;
+            x[3 * k + 2] -= l * xz;
+        }
+    }
+}
+
+#endif // JELLY_BENCH_PD
@@ -0,0 +1,31 @@
+#pragma once
+#include <vector>
+#include <glm/glm.hpp>
+
+// Cholesky factorization L L^T of a sparse symmetric positive definite matrix stored in
+// envelope (profile) form: row i keeps its entries from its first nonzero column up to the
+// diagonal. Fill-in never leaves the envelope, so with a bandwidth-reducing ordering
+// (reverse Cuthill-McKee) the factor stays close to the size of the matrix.
+class EnvelopeCholesky {
+public:
+    // Lower-triangle entries (row >= col); duplicates are summed.
+    struct Entry { int row, col; float value; };
+
+    // Factors the n x n matrix. Returns false if it is not positive definite.
+    bool factor(int n, const std::vector<Entry>& lower);
+
+    // Solves A x = b for three right-hand sides (x, y, z) at once, in place.
+    void solve(glm::vec3* b) const;
+
+    int size() const { return n; }
+    size_t envelopeSize() const { return values.size(); }
+
+private:
+    int n = 0;
+    std::vector<int>   first;    // first column stored in each row
+    std::vector<size_t> rowStart; // offset of row i's entry for column first[i]
+    std::vector<float> values;   // L, row by row, diagonal last in each row
+
+    const float* row(int i) const { return values.data() + rowStart[i] - first[i]; } // indexable by column
+    float* row(int i) { return values.data() + rowStart[i] - first[i]; }
+};
@@ -0,0 +1,150 @@
+#include "FrameCapture.h"
+#include <cstring>
+#include <iostream>
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+FrameCapture::FrameCapture(int width_, int height_, Format format_, std::string path_, int ringSize, JobSystem& jobs_)
+    : width(width_), height(height_), format(format_), path(std::move(path_)), jobs(jobs_), ring(ringSize < 2 ? 2 : ringSize)
+{
+    const GLsizeiptr bytes = (GLsizeiptr)width * height * 4;
+    for (Slot& s : ring) {
+        glGenBuffers(1, &s.pbo);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, s.pbo);
+        glBufferData(GL_PIXEL_PACK_BUFFER, bytes, nullptr, GL_STREAM_READ);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    if (format == Format::RawVideo) {
+        if (path == "-") {
+#ifdef _WIN32
+            // stdout starts in text mode there, which would turn every 0x0A byte into CR LF
+            _setmode(_fileno(stdout), _O_BINARY);
+#endif
+            rawOut = stdout;
+        }
+        else {
+            rawOut = std::fopen(path.c_str(), "wb");
+        }
+        if (!rawOut) {
+            std::cerr << "FrameCapture: cannot open " << path << std::endl;
+            failed = true;
+        }
+    }
+}
+
+FrameCapture::~FrameCapture()
+{
+    for (const JobSystem::Handle& w : writes) jobs.wait(w);
+    if (rawOut && rawOut != stdout) std::fclose(rawOut);
+}
+
+void FrameCapture::capture(GLuint framebuffer)
+{
+    if (failed) return;
+    if (pending == (int)ring.size()) collectOldest();
+
+    // RGBA rows are always 4-byte aligned, which keeps this on the driver's fast path
+    Slot& s = ring[head];
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+    glReadBuffer(GL_COLOR_ATTACHMENT0);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, s.pbo);
+    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+    s.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    s.frame = next++;
+
+    head = (head + 1) % (int)ring.size();
+    ++pending;
+}
+
+void FrameCapture::collectOldest()
+{
+    Slot& s = ring[(head - pending + (int)ring.size()) % (int)ring.size()];
+    --pending;
+
+    // normally long signaled; only count it when we really have to wait
+    if (glClientWaitSync(s.fence, 0, 0) == GL_TIMEOUT_EXPIRED) {
+        ++stallCount;
+        glClientWaitSync(s.fence, GL_SYNC_FLUSH_COMMANDS_BIT, ~GLuint64(0));
+    }
+    glDeleteSync(s.fence);
+    s.fence = 0;
+
+    auto pixels = std::make_shared<std::vector<uint8_t>>((size_t)width * height * 4);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, s.pbo);
+    const void* mapped = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, (GLsizeiptr)pixels->size(), GL_MAP_READ_BIT);
+    if (mapped) {
+        std::memcpy(pixels->data(), mapped, pixels->size());
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    if (!mapped) {
+        // the frame is dropped rather than written as garbage
+        if (mapFailures++ == 0) std::cerr << "FrameCapture: cannot map frame " << s.frame << std::endl;
+        return;
+    }
+
+    // write behind on a job thread, after the previous frame's write; a few in flight at most
+    const int frame = s.frame;
+    const JobSystem::Handle previous = writes.empty() ? nullptr : writes.back();
+    writes.push_back(jobs.spawn([this, frame, pixels] { write(frame, *pixels); }, { previous }));
+    while ((int)writes.size() > (int)ring.size()) {
+        jobs.wait(writes.front());
+        writes.pop_front();
+    }
+}
+
+void FrameCapture::finish()
+{
+    while (pending > 0) collectOldest();
+    for (const JobSystem::Handle& w : writes) jobs.wait(w);
+    writes.clear();
+    if (rawOut && std::fflush(rawOut) != 0) ++writeFailures;   // what was still buffered
+    for (Slot& s : ring) {
+        if (s.fence) glDeleteSync(s.fence);
+        glDeleteBuffers(1, &s.pbo);
+        s = Slot();
+    }
+}
+
+void FrameCapture::write(int index, const std::vector<uint8_t>& rgba)
+{
+    // GL rows run bottom-up; images and video top-down
+    std::vector<uint8_t> rgb((size_t)width * height * 3);
+    for (int y = 0; y < height; ++y) {
+        const uint8_t* src = &rgba[(size_t)(height - 1 - y) * width * 4];
+        uint8_t* dst = &rgb[(size_t)y * width * 3];
+        for (int x = 0; x < width; ++x) {
+            dst[3 * x] = src[4 * x];
+            dst[3 * x + 1] = src[4 * x + 1];
+            dst[3 * x + 2] = src[4 * x + 2];
+        }
+    }
+
+    if (format == Format::RawVideo) {
+        if (std::fwrite(rgb.data(), 1, rgb.size(), rawOut) != rgb.size()) {
+            if (writeFailures++ == 0) std::cerr << "FrameCapture: cannot write " << path << std::endl;
+            return;
+        }
+    }
+    else {
+        char name[32];
+        std::snprintf(name, sizeof(name), "%05d.ppm", index);
+        FILE* f = std::fopen((path + name).c_str(), "wb");
+        bool done = f != nullptr;
+        if (f) {
+            done = std::fprintf(f, "P6\n%d %d\n255\n", width, height) > 0;
+            done = done && std::fwrite(rgb.data(), 1, rgb.size(), f) == rgb.size();
+            done = std::fclose(f) == 0 && done;
+        }
+        if (!done) {
+            if (writeFailures++ == 0) std::cerr << "FrameCapture: cannot write " << path << name << std::endl;
+            return;
+        }
+    }
+    ++written;
+}
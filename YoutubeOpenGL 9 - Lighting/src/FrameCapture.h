@@ -0,0 +1,66 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+#include <glad/glad.h>
+#include "JobSystem.h"
+
+// Reads finished frames back through a ring of pixel buffer objects, so the GL thread never
+// waits for the GPU: glReadPixels only queues a copy into the next PBO, and a PBO is mapped
+// ringSize - 1 frames later, when its copy has long been done. Mapped pixels are handed to
+// job threads that write them out in frame order, so disk or pipe I/O overlaps rendering too.
+class FrameCapture {
+public:
+    enum class Format {
+        ImageSequence,  // one binary PPM per frame: <path>00000.ppm, <path>00001.ppm, ...
+        RawVideo,       // rgb24 frames back to back into one file, or stdout for "-"
+                        // (e.g. | ffmpeg -f rawvideo -pix_fmt rgb24 -s WxH -r 60 -i - out.mp4)
+    };
+
+    FrameCapture(int width, int height, Format format, std::string path, int ringSize = 3,
+        JobSystem& jobs = JobSystem::Shared());
+    ~FrameCapture();   // finish() must have run while the context was still current
+    FrameCapture(const FrameCapture&) = delete;
+    FrameCapture& operator=(const FrameCapture&) = delete;
+
+    // false once the output could not be opened, a frame could not be mapped or a write failed
+    bool ok() const { return !failed && mapFailures == 0 && writeFailures == 0; }
+
+    // Queues a readback of the framebuffer's first color attachment (GL thread).
+    void capture(GLuint framebuffer);
+    // Collects every queued frame and waits for the writes (GL thread); frees the PBOs.
+    void finish();
+
+    int framesWritten() const { return written; }
+    int stalls() const { return stallCount; }   // collects that found their copy unfinished
+    int failures() const { return mapFailures + writeFailures; }  // frames dropped or cut short
+
+private:
+    void collectOldest();
+    void write(int index, const std::vector<uint8_t>& rgba);
+
+    const int width, height;
+    const Format format;
+    const std::string path;
+    JobSystem& jobs;
+
+    struct Slot {
+        GLuint pbo = 0;
+        GLsync fence = 0;
+        int frame = -1;
+    };
+    std::vector<Slot> ring;
+    int head = 0, pending = 0;    // next slot to fill, queued copies not yet collected
+    int next = 0;                 // frame number of the next capture
+
+    std::deque<JobSystem::Handle> writes;   // in frame order; each one runs after the one before
+    FILE* rawOut = nullptr;
+    bool failed = false;
+    int written = 0, stallCount = 0;
+    int mapFailures = 0;                  // GL thread
+    std::atomic<int> writeFailures{ 0 };  // write jobs
+};
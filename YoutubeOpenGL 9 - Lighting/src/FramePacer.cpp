@@ -0,0 +1,127 @@
+#include "FramePacer.h"
+#include <algorithm>
+#include <cstring>
+#include <initializer_list>
+#include <thread>
+
+#ifdef _WIN32
+// 1 ms scheduler ticks instead of the default 15.6, so sleeps can end close to when asked
+extern "C" __declspec(dllimport) unsigned int __stdcall timeBeginPeriod(unsigned int period);
+extern "C" __declspec(dllimport) unsigned int __stdcall timeEndPeriod(unsigned int period);
+#pragma comment(lib, "winmm.lib")
+#endif
+
+namespace {
+
+double toMs(FramePacer::Clock::duration d)
+{
+    return std::chrono::duration<double, std::milli>(d).count();
+}
+
+FramePacer::Clock::duration fromMs(double ms)
+{
+    return std::chrono::duration_cast<FramePacer::Clock::duration>(std::chrono::duration<double, std::milli>(ms));
+}
+
+} // namespace
+
+FramePacer::FramePacer(PacingMode mode_, double hz_, double refreshHz_)
+    : mode(mode_), hz(hz_ > 0.0 ? hz_ : 60.0), refreshHz(refreshHz_ > 0.0 ? refreshHz_ : 60.0),
+    period(fromMs(1000.0 / (hz_ > 0.0 ? hz_ : 60.0)))
+{
+#ifdef _WIN32
+    timeBeginPeriod(1);
+#endif
+}
+
+FramePacer::~FramePacer()
+{
+#ifdef _WIN32
+    timeEndPeriod(1);   // the tick rate is system-wide; every begin needs its end
+#endif
+}
+
+void FramePacer::waitForInput()
+{
+    const Clock::time_point now = Clock::now();
+    if (!started) {
+        schedule = now;
+    }
+    else if (mode == PacingMode::Capped) {
+        // on a fixed grid, so the rate does not drift; a late frame restarts the grid
+        schedule += period;
+        if (schedule < now) schedule = now;
+        waitUntil(schedule);
+    }
+    else if (mode == PacingMode::LowLatency) {
+        // the last SwapBuffers returned at about a refresh, so the next one is a period on;
+        // start just early enough to make it, by the predicted work plus a margin for a
+        // slower frame than usual (missing it costs a refresh, as plain vsync always does)
+        const Clock::duration lead = fromMs(1.25 * work + 1.0);
+        waitUntil(lastPresent + period - lead);
+    }
+
+    inputTime = Clock::now();
+    if (started) {
+        const double ms = toMs(inputTime - lastStart);
+        frameTime = frameTime == 0.0 ? ms : 0.9 * frameTime + 0.1 * ms;
+    }
+    lastStart = inputTime;
+    started = true;
+}
+
+void FramePacer::frameRendered()
+{
+    const double ms = toMs(Clock::now() - inputTime);
+    // rises at once with a slow frame, falls back slowly, so one fast frame does not make
+    // the low-latency wait cut the next one short
+    work = ms > work ? ms : 0.95 * work + 0.05 * ms;
+}
+
+void FramePacer::framePresented()
+{
+    lastPresent = Clock::now();
+    const double ms = toMs(lastPresent - inputTime);
+    // the display scans out at its own rate, whatever the cap
+    const double scanout = (mode == PacingMode::Capped ? 0.5 : 1.0) * 1000.0 / refreshHz;
+    latency = latency == 0.0 ? ms + scanout : 0.9 * latency + 0.1 * (ms + scanout);
+}
+
+void FramePacer::waitUntil(Clock::time_point when)
+{
+    for (;;) {
+        const Clock::time_point now = Clock::now();
+        if (now >= when) return;
+        const double remaining = toMs(when - now);
+        if (remaining > oversleepMs + 0.5) {
+            // sleep most of it, leaving what the OS tends to oversleep by (and a bit)
+            const double asked = remaining - oversleepMs - 0.5;
+            std::this_thread::sleep_for(fromMs(asked));
+            const double late = std::max(toMs(Clock::now() - now) - asked, 0.05);
+            oversleepMs = late > oversleepMs ? late : 0.95 * oversleepMs + 0.05 * late;
+        }
+        else {
+            std::this_thread::yield();
+        }
+    }
+}
+
+const char* FramePacer::Name(PacingMode mode)
+{
+    switch (mode) {
+    case PacingMode::VSync: return "vsync";
+    case PacingMode::Capped: return "cap";
+    case PacingMode::LowLatency: return "lowlatency";
+    }
+    return "?";
+}
+
+bool FramePacer::Parse(const char* name, PacingMode& mode)
+{
+    for (PacingMode m : { PacingMode::VSync, PacingMode::Capped, PacingMode::LowLatency })
+        if (std::strcmp(name, Name(m)) == 0) {
+            mode = m;
+            return true;
+        }
+    return false;
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include <chrono>
+
+// How the window loop paces its frames.
+enum class PacingMode {
+    VSync,       // swap interval 1: SwapBuffers blocks until the display takes the frame, so
+                 // input sampled right after it is a whole refresh old when shown
+    Capped,      // no vsync; frames start at most `hz` times a second
+    LowLatency,  // vsync, but input and physics wait until just before the frame has to start
+                 // to make the next refresh, so what is shown is as fresh as possible
+};
+
+// Decides when the next frame starts: the loop calls waitForInput() before it samples input,
+// frameRendered() once the frame is drawn and framePresented() right after SwapBuffers.
+// Waits sleep for most of the time and spin only for the last stretch, sized by how much
+// the OS has been oversleeping, so an idle wait costs little CPU and still ends on time.
+// No GL or GLFW calls: the loop applies swapInterval() itself.
+class FramePacer {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // hz: the frame rate (the cap, or the display's refresh rate with vsync); refreshHz: the
+    // display's, for the scan-out part of the latency estimate
+    FramePacer(PacingMode mode, double hz, double refreshHz);
+    ~FramePacer();
+    FramePacer(const FramePacer&) = delete;
+    FramePacer& operator=(const FramePacer&) = delete;
+
+    int swapInterval() const { return mode == PacingMode::Capped ? 0 : 1; }
+
+    // LowLatency: the loop should glFinish before frameRendered, so the predicted work covers
+    // the GPU too and the driver queues no frames ahead of the display
+    bool finishBeforeSwap() const { return mode == PacingMode::LowLatency; }
+
+    void waitForInput();     // returns when input should be sampled for the next frame
+    void frameRendered();    // right before SwapBuffers
+    void framePresented();   // right after SwapBuffers returned
+
+    // Input-to-photon estimate, smoothed: from input sampling to SwapBuffers returning, plus
+    // the wait for scan-out (a display refresh with vsync, half of one on average without).
+    double latencyMs() const { return latency; }
+    double frameMs() const { return frameTime; }   // smoothed start-to-start
+    double workMs() const { return work; }         // input sampling to frameRendered, as predicted
+
+    static const char* Name(PacingMode mode);
+    static bool Parse(const char* name, PacingMode& mode);   // "vsync", "cap", "lowlatency"
+
+    const PacingMode mode;
+    const double hz;         // the cap, or the display's refresh rate for vsync
+    const double refreshHz;  // the display's refresh rate
+
+private:
+    void waitUntil(Clock::time_point when);
+
+    Clock::duration period;
+    Clock::time_point schedule;   // Capped: when the next frame starts
+    Clock::time_point lastStart, inputTime, lastPresent;
+    bool started = false;
+    double latency = 0.0, frameTime = 0.0, work = 0.0;
+    double oversleepMs = 1.0;   // how late sleeps wake up, tracked (fast up, slow down)
+};
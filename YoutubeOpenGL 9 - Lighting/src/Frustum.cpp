@@ -0,0 +1,65 @@
+#include "Frustum.h"
+#include <algorithm>
+
+void BoxList::clear()
+{
+    minX.clear(); minY.clear(); minZ.clear();
+    maxX.clear(); maxY.clear(); maxZ.clear();
+}
+
+void BoxList::push(const glm::vec3& mn, const glm::vec3& mx)
+{
+    minX.push_back(mn.x); minY.push_back(mn.y); minZ.push_back(mn.z);
+    maxX.push_back(mx.x); maxY.push_back(mx.y); maxZ.push_back(mx.z);
+}
+
+Frustum Frustum::FromMatrix(const glm::mat4& m)
+{
+    // rows of the matrix (glm is column-major: m[column][row])
+    glm::vec4 row[4];
+    for (int r = 0; r < 4; ++r) row[r] = glm::vec4(m[0][r], m[1][r], m[2][r], m[3][r]);
+
+    Frustum f;
+    f.planes[0] = row[3] + row[0];   // left
+    f.planes[1] = row[3] - row[0];   // right
+    f.planes[2] = row[3] + row[1];   // bottom
+    f.planes[3] = row[3] - row[1];   // top
+    f.planes[4] = row[3] + row[2];   // near
+    f.planes[5] = row[3] - row[2];   // far
+    for (glm::vec4& p : f.planes) p /= glm::length(glm::vec3(p));
+    return f;
+}
+
+bool Frustum::intersects(const glm::vec3& mn, const glm::vec3& mx) const
+{
+    for (const glm::vec4& p : planes) {
+        // the box corner furthest along the plane normal
+        const glm::vec3 far(p.x > 0.0f ? mx.x : mn.x, p.y > 0.0f ? mx.y : mn.y, p.z > 0.0f ? mx.z : mn.z);
+        if (glm::dot(glm::vec3(p), far) + p.w < 0.0f) return false;
+    }
+    return true;
+}
+
+void Frustum::cull(const BoxList& boxes, std::vector<uint32_t>& visible) const
+{
+    const size_t n = boxes.size();
+    visible.resize(n);
+    const float* minX = boxes.minX.data(); const float* maxX = boxes.maxX.data();
+    const float* minY = boxes.minY.data(); const float* maxY = boxes.maxY.data();
+    const float* minZ = boxes.minZ.data(); const float* maxZ = boxes.maxZ.data();
+    uint32_t* out = visible.data();
+    float a[6], b[6], c[6], d[6];
+    for (int k = 0; k < 6; ++k) { a[k] = planes[k].x; b[k] = planes[k].y; c[k] = planes[k].z; d[k] = planes[k].w; }
+
+    // one pass over the boxes; the corner furthest along each plane is picked with max()
+    // instead of a branch, so the loop vectorizes
+    for (size_t i = 0; i < n; ++i) {
+        uint32_t in = 1;
+        for (int k = 0; k < 6; ++k) {
+            const float dist = std::max(a[k] * minX[i], a[k] * maxX[i]) + std::max(b[k] * minY[i], b[k] * maxY[i]) +
+                std::max(c[k] * minZ[i], c[k] * maxZ[i]) + d[k];
+            in &= (uint32_t)(dist >= 0.0f);
+        }
+        out[i] = in;
+    }
+}
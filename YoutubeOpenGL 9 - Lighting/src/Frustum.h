@@ -0,0 +1,33 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+// Axis-aligned boxes as separate coordinate arrays, so Frustum::cull runs over them with
+// straight-line float loops the compiler vectorizes.
+struct BoxList {
+    std::vector<float> minX, minY, minZ, maxX, maxY, maxZ;
+
+    void clear();
+    void push(const glm::vec3& mn, const glm::vec3& mx);
+    size_t size() const { return minX.size(); }
+};
+
+// The six clip planes of a view-projection matrix (Gribb & Hartmann), pointing inward, for
+// culling world-space bounding boxes before anything is built, uploaded or drawn. The box
+// tests are conservative: a box near a frustum corner can pass while being just outside,
+// never the other way round.
+class Frustum {
+public:
+    // clip space as OpenGL has it (-w <= x, y, z <= w), e.g. Camera::cameraMatrix
+    static Frustum FromMatrix(const glm::mat4& viewProjection);
+
+    bool intersects(const glm::vec3& mn, const glm::vec3& mx) const;
+
+    // visible[i] = 1 if box i touches the frustum, else 0; visible is resized to
+    // boxes.size(). One branch-free pass over the boxes, so it vectorizes (the flags are
+    // 32-bit like the coordinates: byte stores could alias the floats and keep it scalar).
+    void cull(const BoxList& boxes, std::vector<uint32_t>& visible) const;
+
+    glm::vec4 planes[6];   // (n, d): n.x + d >= 0 inside; left, right, bottom, top, near, far
+};
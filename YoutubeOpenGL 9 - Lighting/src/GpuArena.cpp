@@ -0,0 +1,246 @@
+#include "GpuArena.h"
+#include <algorithm>
+#include <cassert>
+
+// ---- RangeAllocator ----
+
+RangeAllocator::RangeAllocator(size_t capacity)
+{
+    grow(capacity);
+}
+
+size_t RangeAllocator::allocate(size_t count)
+{
+    if (count == 0) return npos;
+    auto best = bySize.lower_bound({ count, 0 });
+    if (best == bySize.end()) return npos;
+    const size_t first = best->second, left = best->first - count;
+    eraseGap(freeBlocks.find(first));
+    if (left > 0) insertGap(first + count, left);
+    inUse += count;
+    return first;
+}
+
+void RangeAllocator::insertGap(size_t first, size_t count)
+{
+    freeBlocks.emplace(first, count);
+    bySize.emplace(count, first);
+}
+
+void RangeAllocator::eraseGap(std::map<size_t, size_t>::iterator gap)
+{
+    bySize.erase({ gap->second, gap->first });
+    freeBlocks.erase(gap);
+}
+
+void RangeAllocator::free(size_t first, size_t count)
+{
+    if (count == 0) return;
+    inUse -= count;
+    release(first, count);
+}
+
+void RangeAllocator::release(size_t first, size_t count)
+{
+    auto next = freeBlocks.lower_bound(first);
+    if (next != freeBlocks.begin()) {
+        auto prev = std::prev(next);
+        if (prev->first + prev->second == first) { // extend the gap before
+            first = prev->first;
+            count += prev->second;
+            eraseGap(prev);
+        }
+    }
+    if (next != freeBlocks.end() && first + count == next->first) { // swallow the gap after
+        count += next->second;
+        eraseGap(next);
+    }
+    insertGap(first, count);
+}
+
+void RangeAllocator::grow(size_t capacity)
+{
+    if (capacity <= cap) return;
+    const size_t old = cap;
+    cap = capacity;
+    release(old, capacity - old);
+}
+
+void RangeAllocator::compacted(size_t used)
+{
+    freeBlocks.clear();
+    bySize.clear();
+    inUse = used;
+    if (used < cap) insertGap(used, cap - used);
+}
+
+bool RangeAllocator::compact() const
+{
+    return freeBlocks.empty() || (freeBlocks.size() == 1 && freeBlocks.begin()->first == inUse);
+}
+
+// ---- GpuArena::Range ----
+
+GpuArena::Range::Range(Range&& other) noexcept
+    : arena(other.arena), slot(other.slot)
+{
+    other.arena = nullptr;
+}
+
+GpuArena::Range& GpuArena::Range::operator=(Range&& other) noexcept
+{
+    if (this != &other) {
+        reset();
+        arena = other.arena;
+        slot = other.slot;
+        other.arena = nullptr;
+    }
+    return *this;
+}
+
+size_t GpuArena::Range::first() const { return arena->slots[slot].first; }
+size_t GpuArena::Range::count() const { return arena->slots[slot].count; }
+
+void GpuArena::Range::reset()
+{
+    if (!arena) return;
+    arena->release(slot);
+    arena = nullptr;
+}
+
+// ---- GpuArena ----
+
+GpuArena::GpuArena(std::vector<Stream> streams_, size_t capacity)
+    : allocator(capacity), streams(std::move(streams_)), scratch(nullptr, 0, GL_STREAM_COPY)
+{
+    for (const Stream& s : streams) buffers.emplace_back(nullptr, (GLsizeiptr)capacity * s.stride, s.usage);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+GpuArena::~GpuArena()
+{
+    assert(rangeCount() == 0 && "GpuArena destroyed while ranges are still alive");
+}
+
+GpuArena::Range GpuArena::allocate(size_t count)
+{
+    size_t first = allocator.allocate(count);
+    if (first == RangeAllocator::npos) {
+        // compacting is a copy of what is in use; growing copies everything and keeps the
+        // gaps, so only grow when compacting would not make room. Growing by at least count
+        // leaves a tail that fits, unless the limit cut it short: then compact as well.
+        if (allocator.capacity() - allocator.used() >= count) defragment();
+        else if (allocator.used() + count <= limit) grow(std::min(std::max(2 * allocator.capacity(), allocator.capacity() + count), limit));
+        first = allocator.allocate(count);
+        if (first == RangeAllocator::npos && allocator.capacity() - allocator.used() >= count) {
+            defragment();
+            first = allocator.allocate(count);
+        }
+    }
+
+    Range range;
+    if (first == RangeAllocator::npos) return range; // count == 0, or past the limit
+    uint32_t slot;
+    if (!freeSlots.empty()) {
+        slot = freeSlots.back();
+        freeSlots.pop_back();
+    }
+    else {
+        slot = (uint32_t)slots.size();
+        slots.push_back({});
+    }
+    slots[slot] = { first, count };
+    range.arena = this;
+    range.slot = slot;
+    return range;
+}
+
+void GpuArena::release(uint32_t slot)
+{
+    allocator.free(slots[slot].first, slots[slot].count);
+    slots[slot] = { 0, 0 };
+    freeSlots.push_back(slot);
+}
+
+void GpuArena::upload(const Range& range, int stream, const void* data, size_t count, size_t offset)
+{
+    assert(range.arena == this && offset + count <= range.count());
+    const GLsizeiptr stride = streams[stream].stride;
+    // the copy targets leave the array and element bindings (and so any bound VAO) alone
+    glBindBuffer(GL_COPY_WRITE_BUFFER, buffers[stream].ID);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, (GLintptr)((range.first() + offset) * stride), (GLsizeiptr)count * stride, data);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+void GpuArena::reserveScratch(GLsizeiptr bytes)
+{
+    if (bytes <= scratchBytes) return;
+    glBindBuffer(GL_COPY_WRITE_BUFFER, scratch.ID);
+    glBufferData(GL_COPY_WRITE_BUFFER, bytes, nullptr, GL_STREAM_COPY);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    scratchBytes = bytes;
+}
+
+void GpuArena::grow(size_t capacity)
+{
+    // respecify each buffer at the new size, keeping its name, with the old contents staged
+    // through the scratch buffer
+    const size_t old = allocator.capacity();
+    for (size_t s = 0; s < streams.size(); ++s) {
+        const GLsizeiptr oldBytes = (GLsizeiptr)old * streams[s].stride;
+        reserveScratch(oldBytes);
+        glBindBuffer(GL_COPY_READ_BUFFER, buffers[s].ID);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, scratch.ID);
+        if (oldBytes > 0) glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, oldBytes);
+        glBufferData(GL_COPY_READ_BUFFER, (GLsizeiptr)capacity * streams[s].stride, nullptr, streams[s].usage);
+        if (oldBytes > 0) glCopyBufferSubData(GL_COPY_WRITE_BUFFER, GL_COPY_READ_BUFFER, 0, 0, oldBytes);
+    }
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    allocator.grow(capacity);
+    ++moves;
+}
+
+void GpuArena::defragment()
+{
+    if (allocator.compact()) return;
+
+    std::vector<uint32_t> live;
+    for (uint32_t s = 0; s < (uint32_t)slots.size(); ++s)
+        if (slots[s].count > 0) live.push_back(s);
+    std::sort(live.begin(), live.end(), [&](uint32_t a, uint32_t b) { return slots[a].first < slots[b].first; });
+
+    // pack the live ranges into the scratch buffer, then copy them back in one piece
+    // (glCopyBufferSubData may not overlap within one buffer)
+    for (size_t s = 0; s < streams.size(); ++s) {
+        const GLsizeiptr stride = streams[s].stride;
+        reserveScratch((GLsizeiptr)allocator.used() * stride);
+        glBindBuffer(GL_COPY_READ_BUFFER, buffers[s].ID);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, scratch.ID);
+        size_t cursor = 0;
+        for (uint32_t slot : live) {
+            const Slot& r = slots[slot];
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER,
+                (GLintptr)(r.first * stride), (GLintptr)(cursor * stride), (GLsizeiptr)r.count * stride);
+            cursor += r.count;
+        }
+        if (cursor > 0)
+            glCopyBufferSubData(GL_COPY_WRITE_BUFFER, GL_COPY_READ_BUFFER, 0, 0, (GLsizeiptr)cursor * stride);
+    }
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    size_t cursor = 0;
+    for (uint32_t slot : live) {
+        slots[slot].first = cursor;
+        cursor += slots[slot].count;
+    }
+    allocator.compacted(cursor);
+    ++moves;
+}
+
+float GpuArena::fragmentation() const
+{
+    const size_t free = allocator.capacity() - allocator.used();
+    return free > 0 ? 1.0f - (float)allocator.largestFree() / (float)free : 0.0f;
+}
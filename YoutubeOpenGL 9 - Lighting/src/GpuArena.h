@@ -0,0 +1,120 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <set>
+#include <utility>
+#include <vector>
+#include <glad/glad.h>
+#include "VBO.h"
+
+// Element ranges within a fixed capacity: best fit (smallest gap that holds the range, lowest
+// offset among equals), with neighbouring gaps merged on free. The gaps are indexed both by
+// offset, for merging, and by size, so both are O(log gaps). Pure bookkeeping; GpuArena
+// puts GL buffers behind it.
+class RangeAllocator {
+public:
+    static constexpr size_t npos = (size_t)-1;
+
+    explicit RangeAllocator(size_t capacity = 0);
+
+    size_t allocate(size_t count);          // first element, or npos when no gap is big enough
+    void   free(size_t first, size_t count);
+    void   grow(size_t capacity);           // the new tail is free
+    void   compacted(size_t used);          // everything below `used` taken, the rest one gap
+
+    size_t capacity() const { return cap; }
+    size_t used() const { return inUse; }
+    size_t largestFree() const { return bySize.empty() ? 0 : bySize.rbegin()->first; }
+    size_t freeBlockCount() const { return freeBlocks.size(); }
+    bool   compact() const;                 // all free space is one gap at the end
+
+private:
+    void release(size_t first, size_t count);  // merges with the neighbouring gaps
+    void insertGap(size_t first, size_t count);
+    void eraseGap(std::map<size_t, size_t>::iterator gap);
+
+    std::map<size_t, size_t> freeBlocks;       // first -> count
+    std::set<std::pair<size_t, size_t>> bySize; // (count, first)
+    size_t cap = 0, inUse = 0;
+};
+
+// Hands out element ranges of a few large GL buffers, so many meshes share the same buffer
+// objects and creating or dropping a mesh creates or deletes none. An arena has one or more
+// streams (say positions and packed normals), each its own buffer with its own stride; a
+// range covers the same elements in every stream, so one base vertex addresses them all.
+//
+// When no gap fits, the arena compacts itself if that frees enough room and otherwise
+// doubles, up to its capacity limit; past that allocate returns an empty Range. Compacting
+// and growing keep the buffer names, so VAOs and texture buffers built on them stay
+// valid, but both move ranges: read first() when drawing rather than keeping it.
+class GpuArena {
+public:
+    struct Stream {
+        GLsizeiptr stride;   // bytes per element
+        GLenum usage;        // GL_STATIC_DRAW, GL_DYNAMIC_DRAW, ...
+    };
+
+    // A live range; move-only, returns itself to the arena when destroyed or reset.
+    class Range {
+    public:
+        Range() = default;
+        Range(Range&& other) noexcept;
+        Range& operator=(Range&& other) noexcept;
+        Range(const Range&) = delete;
+        Range& operator=(const Range&) = delete;
+        ~Range() { reset(); }
+
+        explicit operator bool() const { return arena != nullptr; }
+        size_t first() const;   // current first element (changes when the arena compacts)
+        size_t count() const;
+        void reset();
+
+    private:
+        friend class GpuArena;
+        GpuArena* arena = nullptr;
+        uint32_t slot = 0;
+    };
+
+    GpuArena(std::vector<Stream> streams, size_t capacity);
+    ~GpuArena();                            // every Range must be gone by now
+    GpuArena(const GpuArena&) = delete;
+    GpuArena& operator=(const GpuArena&) = delete;
+
+    Range allocate(size_t count);          // empty when count is 0 or the limit is reached
+
+    // Writes count elements of one stream, starting `offset` elements into the range.
+    void upload(const Range& range, int stream, const void* data, size_t count, size_t offset = 0);
+
+    // Slides every live range down so the free space is one block at the end.
+    void defragment();
+
+    // most elements the arena may grow to, say what a texture buffer can address
+    void setCapacityLimit(size_t elements) { limit = elements; }
+
+    GLuint buffer(int stream) const { return buffers[stream].ID; }
+    size_t capacity() const { return allocator.capacity(); }
+    size_t used() const { return allocator.used(); }
+    size_t rangeCount() const { return slots.size() - freeSlots.size(); }
+    float  fragmentation() const;           // 1 - largest gap / free space (0 = one gap)
+    unsigned generation() const { return moves; }  // bumped whenever ranges move or buffers resize
+
+private:
+    struct Slot {
+        size_t first, count;
+    };
+
+    void release(uint32_t slot);
+    void grow(size_t capacity);
+    void reserveScratch(GLsizeiptr bytes);
+
+    RangeAllocator allocator;
+    std::vector<Stream> streams;
+    std::vector<VBO> buffers;               // one per stream
+    VBO scratch;                            // staging for grow and defragment, kept for reuse
+    GLsizeiptr scratchBytes = 0;
+    std::vector<Slot> slots;                // indexed by Range::slot
+    std::vector<uint32_t> freeSlots;
+    unsigned moves = 0;
+    size_t limit = (size_t)-1;
+};
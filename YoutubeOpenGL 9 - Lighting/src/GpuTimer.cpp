@@ -0,0 +1,44 @@
+#include "GpuTimer.h"
+
+GpuTimer::GpuTimer(int depth) : queries(depth < 2 ? 2 : depth)
+{
+    glGenQueries((GLsizei)queries.size(), queries.data());
+}
+
+GpuTimer::~GpuTimer()
+{
+    glDeleteQueries((GLsizei)queries.size(), queries.data());
+}
+
+void GpuTimer::begin()
+{
+    timing = inFlight < (int)queries.size();
+    if (timing) glBeginQuery(GL_TIME_ELAPSED, queries[head]);
+}
+
+void GpuTimer::end()
+{
+    if (!timing) return;
+    glEndQuery(GL_TIME_ELAPSED);
+    head = (head + 1) % (int)queries.size();
+    ++inFlight;
+    timing = false;
+}
+
+bool GpuTimer::poll(double& ms)
+{
+    bool got = false;
+    // results arrive in submission order, so stop at the first one still pending
+    while (inFlight > 0) {
+        const GLuint query = queries[(head - inFlight + (int)queries.size()) % (int)queries.size()];
+        GLint available = 0;
+        glGetQueryObjectiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) break;
+        GLuint64 ns = 0;
+        glGetQueryObjectui64v(query, GL_QUERY_RESULT, &ns);
+        ms = (double)ns * 1e-6;
+        --inFlight;
+        got = true;
+    }
+    return got;
+}
@@ -0,0 +1,25 @@
+#pragma once
+#include <vector>
+#include <glad/glad.h>
+
+// GPU time of a span of GL commands (GL_TIME_ELAPSED queries), read back without stalling:
+// each frame's query goes into a ring and its result is picked up once the GPU has got
+// there, typically a frame or two later. Only one span can be timed at a time.
+class GpuTimer {
+public:
+    explicit GpuTimer(int depth = 4);
+    ~GpuTimer();
+    GpuTimer(const GpuTimer&) = delete;
+    GpuTimer& operator=(const GpuTimer&) = delete;
+
+    void begin();   // skips the span (no query) when all of the ring is still in flight
+    void end();
+
+    // The newest result that has come in since the last call, in milliseconds; false if none.
+    bool poll(double& ms);
+
+private:
+    std::vector<GLuint> queries;
+    int head = 0, inFlight = 0;
+    bool timing = false;
+};
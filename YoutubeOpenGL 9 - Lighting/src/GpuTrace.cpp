@@ -0,0 +1,68 @@
+#include "GpuTrace.h"
+
+GpuTrace::GpuTrace(int depth) : spans(depth < 2 ? 2 : depth)
+{
+    for (Span& s : spans) {
+        s.name = nullptr;
+        glGenQueries(1, &s.start);
+        glGenQueries(1, &s.end);
+    }
+}
+
+GpuTrace::~GpuTrace()
+{
+    for (Span& s : spans) {
+        glDeleteQueries(1, &s.start);
+        glDeleteQueries(1, &s.end);
+    }
+}
+
+void GpuTrace::calibrate()
+{
+    // the two clocks are read back to back; the error is the time between the reads
+    Tracer& tracer = Tracer::Shared();
+    GLint64 gpuNow = 0;
+    glGetInteger64v(GL_TIMESTAMP, &gpuNow);
+    const int64_t cpuNow = tracer.now();
+    gpuToTracer = cpuNow - (int64_t)gpuNow;
+    calibratedAt = cpuNow;
+}
+
+void GpuTrace::begin(const char* name)
+{
+    timing = Tracer::Shared().isEnabled() && inFlight < (int)spans.size();
+    if (!timing) return;
+    if (calibratedAt < 0) calibrate();
+    spans[head].name = name;
+    glQueryCounter(spans[head].start, GL_TIMESTAMP);
+}
+
+void GpuTrace::end()
+{
+    if (!timing) return;
+    glQueryCounter(spans[head].end, GL_TIMESTAMP);
+    head = (head + 1) % (int)spans.size();
+    ++inFlight;
+    timing = false;
+}
+
+void GpuTrace::poll()
+{
+    if (inFlight == 0) return;
+    Tracer& tracer = Tracer::Shared();
+    if (!lane) lane = &tracer.lane("GPU");
+    if (tracer.now() - calibratedAt > 1000000000) calibrate();   // follow clock drift
+
+    // results arrive in submission order, so stop at the first span still pending
+    while (inFlight > 0) {
+        const Span& s = spans[(head - inFlight + (int)spans.size()) % (int)spans.size()];
+        GLint available = 0;
+        glGetQueryObjectiv(s.end, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) break;
+        GLuint64 start = 0, end = 0;
+        glGetQueryObjectui64v(s.start, GL_QUERY_RESULT, &start);
+        glGetQueryObjectui64v(s.end, GL_QUERY_RESULT, &end);
+        lane->record(s.name, (int64_t)start + gpuToTracer, (int64_t)end + gpuToTracer);
+        --inFlight;
+    }
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include <vector>
+#include <glad/glad.h>
+#include "Tracer.h"
+
+// GPU phases on the shared Tracer's timeline, in a lane of their own ("GPU"): each span
+// puts a GL_TIMESTAMP query (glQueryCounter) before and after its commands, and poll picks
+// the pairs up once the GPU has got there, without stalling. GPU timestamps are mapped onto
+// the tracer's clock by reading the GPU clock directly (GL_TIMESTAMP) next to a CPU clock
+// read, about once a second, so the GPU lane lines up with the CPU's. Spans follow one
+// another, they do not nest; with the tracer disabled nothing is queried.
+class GpuTrace {
+public:
+    explicit GpuTrace(int depth = 64);
+    ~GpuTrace();
+    GpuTrace(const GpuTrace&) = delete;
+    GpuTrace& operator=(const GpuTrace&) = delete;
+
+    // name must outlive the tracer (string literals); skips the span when the tracer is off
+    // or all of the ring is still in flight
+    void begin(const char* name);
+    void end();
+
+    // Records the spans whose results have come in; once a frame.
+    void poll();
+
+private:
+    struct Span {
+        const char* name;
+        GLuint start, end;
+    };
+
+    void calibrate();
+
+    std::vector<Span> spans;
+    int head = 0, inFlight = 0;
+    bool timing = false;
+    Tracer::Ring* lane = nullptr;   // created on the first span
+    int64_t gpuToTracer = 0;        // add to a GPU timestamp for the tracer's time
+    int64_t calibratedAt = -1;      // tracer time of the last calibration
+};
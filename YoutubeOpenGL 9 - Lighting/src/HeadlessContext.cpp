@@ -0,0 +1,90 @@
+#include "HeadlessContext.h"
+#include <glad/glad.h>
+
+#ifdef __linux__
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+bool HeadlessContext::create()
+{
+    // surfaceless platform first (no display server or GPU device needed), else whatever
+    // EGL picks by default
+    EGLDisplay dpy = EGL_NO_DISPLAY;
+    auto getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+    if (getPlatformDisplay) dpy = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+    if (dpy == EGL_NO_DISPLAY) dpy = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    EGLint major = 0, minor = 0;
+    if (dpy == EGL_NO_DISPLAY || !eglInitialize(dpy, &major, &minor)) {
+        lastError = "no EGL display";
+        return false;
+    }
+    display = dpy;
+    if (!eglBindAPI(EGL_OPENGL_API)) {
+        lastError = "EGL has no desktop OpenGL";
+        return false;
+    }
+
+    // no config and no surface: everything is drawn into framebuffer objects
+    const EGLint attribs[] = {
+        EGL_CONTEXT_MAJOR_VERSION, 3,
+        EGL_CONTEXT_MINOR_VERSION, 3,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE
+    };
+    EGLContext ctx = eglCreateContext(dpy, (EGLConfig)0, EGL_NO_CONTEXT, attribs);
+    if (ctx == EGL_NO_CONTEXT) {
+        lastError = "no GL 3.3 core context (EGL_KHR_no_config_context / surfaceless missing?)";
+        return false;
+    }
+    context = ctx;
+    if (!eglMakeCurrent(dpy, EGL_NO_SURFACE, EGL_NO_SURFACE, ctx)) {
+        lastError = "could not make the context current";
+        return false;
+    }
+    if (!gladLoadGLLoader((GLADloadproc)eglGetProcAddress)) {
+        lastError = "could not load GL functions";
+        return false;
+    }
+    return true;
+}
+
+HeadlessContext::~HeadlessContext()
+{
+    if (!display) return;
+    eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    if (context) eglDestroyContext(display, context);
+    eglTerminate(display);
+}
+
+#else
+#include <GLFW/glfw3.h>
+
+bool HeadlessContext::create()
+{
+    if (!glfwInit()) {
+        lastError = "GLFW failed to initialize";
+        return false;
+    }
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    window = glfwCreateWindow(16, 16, "Jelly Cubes (headless)", NULL, NULL);
+    if (!window) {
+        lastError = "could not create a hidden GLFW window";
+        glfwTerminate();
+        return false;
+    }
+    glfwMakeContextCurrent(window);
+    gladLoadGL();
+    return true;
+}
+
+HeadlessContext::~HeadlessContext()
+{
+    if (!window) return;
+    glfwDestroyWindow(window);
+    glfwTerminate();
+}
+
+#endif
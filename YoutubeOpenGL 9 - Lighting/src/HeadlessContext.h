@@ -0,0 +1,29 @@
+#pragma once
+#include <string>
+
+struct GLFWwindow;
+
+// A GL 3.3 core context made current on the calling thread without showing a window, for
+// rendering into framebuffer objects only (there is no usable default framebuffer). On Linux
+// it is a surfaceless EGL context, so it runs on a machine with no display at all (Mesa's
+// llvmpipe included); elsewhere it falls back to a hidden GLFW window. glad is loaded.
+class HeadlessContext {
+public:
+    HeadlessContext() = default;
+    ~HeadlessContext();
+    HeadlessContext(const HeadlessContext&) = delete;
+    HeadlessContext& operator=(const HeadlessContext&) = delete;
+
+    // false (with error() saying why) if no such context could be had
+    bool create();
+    const std::string& error() const { return lastError; }
+
+private:
+    std::string lastError;
+#ifdef __linux__
+    void* display = nullptr;   // EGLDisplay
+    void* context = nullptr;   // EGLContext
+#else
+    GLFWwindow* window = nullptr;
+#endif
+};
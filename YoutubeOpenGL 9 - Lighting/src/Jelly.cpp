@@ -1,131 +1,70 @@
 #include "Jelly.h"
+#include "SpringOverlay.h"
+#include "JobSystem.h"
+#include <glm/gtc/packing.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include <glm/gtx/norm.hpp>
 #include <algorithm>
 #include <cmath>
-#include <unordered_map>
-
-static inline float clampf(float x, float a, float b) { return std::max(a, std::min(b, x)); }
 
 Jelly::Jelly(glm::vec3 center_, float radius_, glm::vec3 velocity_, glm::vec3 acceleration_,
-    float pointMass_, float springStrength_, int springsPerEdge_)
+    float pointMass_, float springStrength_, int springsPerEdge_, bool reorderParticles, VolumeMode volumeMode_)
     : center(center_), radius(radius_), velocity(velocity_), acceleration(acceleration_),
     pointMass(pointMass_), springStrength(springStrength_), springsPerEdge(springsPerEdge_),
-    vbo(nullptr), ebo(nullptr)
+    volumeMode(volumeMode_)
 {
-    GenerateCubeMesh(); // builds particles, springs, render vertices/indices
-
-    originalVertices = vertices;
-
-    vao.Bind();
-    vbo = new VBO(vertices.data(), (GLsizeiptr)(vertices.size() * sizeof(GLfloat)));
-    ebo = new EBO(indices.data(), (GLsizeiptr)(indices.size() * sizeof(GLuint)));
-    vao.LinkAttrib(*vbo, 0, 3, GL_FLOAT, 11 * sizeof(float), (void*)0);                   // pos
-    vao.LinkAttrib(*vbo, 1, 3, GL_FLOAT, 11 * sizeof(float), (void*)(3 * sizeof(float))); // normal
-    vao.LinkAttrib(*vbo, 2, 2, GL_FLOAT, 11 * sizeof(float), (void*)(6 * sizeof(float))); // uv
-    vao.LinkAttrib(*vbo, 3, 3, GL_FLOAT, 11 * sizeof(float), (void*)(8 * sizeof(float))); // color
-    vao.Unbind(); vbo->Unbind(); ebo->Unbind();
-
+    topo = JellyTopology::Get(springsPerEdge, radius, springStrength, reorderParticles,
+        volumeMode == VolumeMode::BodySprings);
+    GenerateCubeMesh(); // builds particles and render vertices
     updateAABB();
 }
 
-// Build particles as a per-face grid on a cube and create springs along the grids.
-// Surface lattice (not volumetric) for speed.
-void Jelly::GenerateCubeMesh()
+void Jelly::initGPU(JellyMeshPool& pool)
 {
-    // Use MEMBER S and MEMBER facePointIdx
-    S = std::max(2, springsPerEdge + 1);
-    facePointIdx.assign(6, std::vector<int>(S * S, -1));
-
-    particles.clear(); springs.clear(); vertices.clear(); indices.clear();
-
-    const float half = radius * 0.5f;
-
-    auto addParticle = [&](const glm::vec3& pos) {
-        Particle p{};
-        p.p = pos; p.prev = pos; p.a = glm::vec3(0.0f);
-        p.invMass = (pointMass > 0.0f) ? (1.0f / pointMass) : 0.0f;
-        particles.push_back(p);
-        return (int)particles.size() - 1;
-        };
-
-    struct FaceDef { glm::vec3 origin, ex, ey, normal; };
-    std::vector<FaceDef> faces = {
-        { center + glm::vec3(-half, -half, +half), glm::vec3(radius / (S - 1),0,0), glm::vec3(0, radius / (S - 1),0), glm::vec3(0,0, 1) },
-        { center + glm::vec3(half, -half, -half), glm::vec3(-radius / (S - 1),0,0), glm::vec3(0, radius / (S - 1),0), glm::vec3(0,0,-1) },
-        { center + glm::vec3(+half, -half, -half), glm::vec3(0,0, radius / (S - 1)), glm::vec3(0, radius / (S - 1),0), glm::vec3(1,0, 0) },
-        { center + glm::vec3(-half, -half, +half), glm::vec3(0,0,-radius / (S - 1)), glm::vec3(0, radius / (S - 1),0), glm::vec3(-1,0,0) },
-        { center + glm::vec3(-half, +half, -half), glm::vec3(radius / (S - 1),0,0), glm::vec3(0,0, radius / (S - 1)), glm::vec3(0,1, 0) },
-        { center + glm::vec3(-half, -half, +half), glm::vec3(radius / (S - 1),0,0), glm::vec3(0,0,-radius / (S - 1)), glm::vec3(0,-1,0) },
-    };
-
-    auto keyOf = [&](const glm::vec3& p)->glm::ivec3 {
-        const float q = 1e-4f;
-        return glm::ivec3((int)std::round(p.x / q), (int)std::round(p.y / q), (int)std::round(p.z / q));
-        };
-    struct KeyHash {
-        size_t operator()(const glm::ivec3& k) const noexcept {
-            return ((size_t)k.x * 73856093) ^ ((size_t)k.y * 19349663) ^ ((size_t)k.z * 83492791);
-        }
-    };
-    std::unordered_map<glm::ivec3, int, KeyHash> lut;
-
-    // Fill the MEMBER facePointIdx
+    // static stream, per render vertex: [particle index,] normal as 10:10:10:2 snorm, uv as
+    // two halves
+    const bool particleBuffer = renderPath == RenderPath::ParticleBuffer;
+    if (particleBuffer) {
+        gpuParticles = pool.particles.allocate(particles.size());
+        if (!gpuParticles) return;   // past what the position texture can address
+    }
+    const int S = topo->S;
+    const int words = particleBuffer ? 3 : 2;
+    std::vector<uint32_t> packed((size_t)topo->vertexCount() * words);
     for (int f = 0; f < 6; ++f) {
-        const auto& fd = faces[f];
-        for (int v = 0; v < S; ++v) {
-            for (int u = 0; u < S; ++u) {
-                glm::vec3 pos = fd.origin + fd.ex * (float)u + fd.ey * (float)v;
-                auto k = keyOf(pos);
-                auto it = lut.find(k);
-                int idx;
-                if (it == lut.end()) { idx = addParticle(pos); lut.emplace(k, idx); }
-                else { idx = it->second; }
-                facePointIdx[f][v * S + u] = idx;
-            }
+        const uint32_t n = glm::packSnorm3x10_1x2(glm::vec4(topo->faceNormals[f], 0.0f));
+        for (int i = f * S * S; i < (f + 1) * S * S; ++i) {
+            uint32_t* v = &packed[(size_t)i * words];
+            if (particleBuffer) *v++ = (uint32_t)topo->facePointIdx[i]; // relative to gpuParticles
+            v[0] = n;
+            v[1] = glm::packHalf2x16(topo->uvs[i]);
         }
     }
 
-    auto addSpring = [&](int a, int b, float k) {
-        if (a == b) return;
-        float rest = glm::length(particles[a].p - particles[b].p);
-        springs.push_back({ a,b,rest,k });
-        };
-    for (int f = 0; f < 6; ++f) {
-        for (int v = 0; v < S; ++v) {
-            for (int u = 0; u < S; ++u) {
-                int i = facePointIdx[f][v * S + u];
-                if (u + 1 < S) addSpring(i, facePointIdx[f][v * S + (u + 1)], springStrength);
-                if (v + 1 < S) addSpring(i, facePointIdx[f][(v + 1) * S + u], springStrength);
-                if (u + 1 < S && v + 1 < S) addSpring(i, facePointIdx[f][(v + 1) * S + (u + 1)], springStrength * 0.7f);
-                if (u > 0 && v + 1 < S) addSpring(i, facePointIdx[f][(v + 1) * S + (u - 1)], springStrength * 0.7f);
-            }
-        }
+    gpuVertices = pool.vertices.allocate(topo->vertexCount());
+    gpuIndices = pool.indices.allocate(topo->indices.size());
+    if (!gpuVertices || !gpuIndices) {
+        // not drawn; IsUploaded() stays false and the next upload tries again
+        gpuVertices.reset();
+        gpuParticles.reset();
+        gpuIndices.reset();
+        return;
     }
+    pool.vertices.upload(gpuVertices, particleBuffer ? 0 : 1, packed.data(), topo->vertexCount());
+    pool.indices.upload(gpuIndices, 0, topo->indices.data(), topo->indices.size());
+}
 
-    // Add body springs between opposite faces to preserve thickness.
-    // Face pairs: 0 <-> 1 (+Z <-> -Z), 2 <-> 3 (+X <-> -X), 4 <-> 5 (+Y <-> -Y)
-    // Because some faces use reversed axes, we mirror (u or v) to match positions.
-    auto addPairSprings = [&](int fA, int fB, bool mirrorU, bool mirrorV, float k) {
-        for (int v = 0; v < S; ++v) {
-            for (int u = 0; u < S; ++u) {
-                int ua = u, va = v;
-                int ub = mirrorU ? (S - 1 - u) : u;
-                int vb = mirrorV ? (S - 1 - v) : v;
-                int ia = facePointIdx[fA][va * S + ua];
-                int ib = facePointIdx[fB][vb * S + ub];
-                if (ia == ib) continue;           // edges/corners may coincide via LUT
-                float rest = glm::length(particles[ia].p - particles[ib].p);
-                springs.push_back({ ia, ib, rest, k });
-            }
-        }
-        };
+// Place particles on the shared surface lattice (springs/indices come from the topology).
+// Surface lattice (not volumetric) for speed.
+void Jelly::GenerateCubeMesh()
+{
+    const float invMass = (pointMass > 0.0f) ? (1.0f / pointMass) : 0.0f;
 
-    // Slightly softer than surface springs so they stabilize without getting too stiff
-    const float bodyK = springStrength * 0.6f;
-    addPairSprings(0, 1, /*mirrorU=*/true,  /*mirrorV=*/false, bodyK); // +Z <-> -Z
-    addPairSprings(2, 3, /*mirrorU=*/true,  /*mirrorV=*/false, bodyK); // +X <-> -X
-    addPairSprings(4, 5, /*mirrorU=*/false, /*mirrorV=*/true, bodyK); // +Y <-> -Y
+    particles.resize(topo->restOffsets.size());
+    for (size_t i = 0; i < particles.size(); ++i) {
+        const glm::vec3 pos = center + topo->restOffsets[i];
+        particles[i] = { pos, pos, glm::vec3(0.0f), invMass };
+    }
 
     rebuildIndicesAndAttributes();
     updateAABB();
@@ -133,61 +72,27 @@ void Jelly::GenerateCubeMesh()
 
 void Jelly::rebuildIndicesAndAttributes()
 {
-    vertices.clear();
-    indices.clear();
-
-    const float half = radius * 0.5f;
-
-    struct FaceDef { glm::vec3 normal, axisU, axisV, origin; };
-    std::vector<FaceDef> fdef = {
-        {{0,0,1},{1,0,0},{0,1,0}, center + glm::vec3(-half,-half,+half)}, // +Z
-        {{0,0,-1},{-1,0,0},{0,1,0}, center + glm::vec3(+half,-half,-half)},// -Z
-        {{1,0,0},{0,0,1},{0,1,0}, center + glm::vec3(+half,-half,-half)}, // +X
-        {{-1,0,0},{0,0,-1},{0,1,0}, center + glm::vec3(-half,-half,+half)},// -X
-        {{0,1,0},{1,0,0},{0,0,1}, center + glm::vec3(-half,+half,-half)}, // +Y
-        {{0,-1,0},{1,0,0},{0,0,-1},center + glm::vec3(-half,-half,+half)} // -Y
-    };
-
-    const glm::vec3 color(1.0f, 0.2f, 0.6f);
-
-    for (int f = 0; f < 6; ++f) {
-        const auto& fd = fdef[f];
-        const GLuint base = (GLuint)(vertices.size() / 11);
-
-        for (int v = 0; v < S; ++v) {
-            for (int u = 0; u < S; ++u) {
-                int pi = facePointIdx[f][v * S + u];
-                if (pi < 0 || pi >= (int)particles.size()) pi = 0; // fallback to a valid index
-                const glm::vec3 p = particles[pi].p; // LIVE particle position
-
-                float uu = (float)u / (float)(S - 1);
-                float vv = (float)v / (float)(S - 1);
-
-                // pos, normal (flat), uv, color
-                vertices.insert(vertices.end(), {
-                    p.x,p.y,p.z,
-                    fd.normal.x,fd.normal.y,fd.normal.z,
-                    uu,vv,
-                    color.r,color.g,color.b
-                    });
-            }
-        }
-        for (int v = 0; v < S - 1; ++v) {
-            for (int u = 0; u < S - 1; ++u) {
-                GLuint i0 = base + v * S + u;
-                GLuint i1 = base + v * S + (u + 1);
-                GLuint i2 = base + (v + 1) * S + (u + 1);
-                GLuint i3 = base + (v + 1) * S + u;
-                indices.insert(indices.end(), { i0,i1,i2,  i0,i2,i3 });
-            }
-        }
+    if (renderPath == RenderPath::ParticleBuffer) {
+        // the GPU finds each vertex's particle itself
+        renderPositions.resize(particles.size());
+        for (size_t i = 0; i < particles.size(); ++i) renderPositions[i] = particles[i].p;
+        return;
     }
+
+    // render vertex i is face point i (faces, then rows, then columns), at its LIVE particle
+    const int count = topo->vertexCount();
+    renderPositions.resize(count);
+    for (int i = 0; i < count; ++i) renderPositions[i] = particles[topo->facePointIdx[i]].p;
 }
 
-void Jelly::updateGPU()
+void Jelly::updateGPU(JellyMeshPool& pool)
 {
-    vbo->Bind();
-    glBufferSubData(GL_ARRAY_BUFFER, 0, (GLsizeiptr)(vertices.size() * sizeof(GLfloat)), vertices.data());
+    if (!gpuVertices) initGPU(pool);
+    if (!gpuVertices) return;
+    if (renderPath == RenderPath::ParticleBuffer)
+        pool.particles.upload(gpuParticles, 0, renderPositions.data(), renderPositions.size());
+    else
+        pool.vertices.upload(gpuVertices, 0, renderPositions.data(), renderPositions.size());
 }
 
 void Jelly::applyGravity() { for (auto& p : particles) p.a += glm::vec3(0, -9.81f, 0); }
@@ -204,89 +109,323 @@ void Jelly::integrate(float dt)
     }
 }
 
-void Jelly::satisfyConstraints(int iterations)
+void Jelly::satisfyConstraints(int iterations, float dt)
 {
     // k in [0,1]; higher = stiffer. Use per-iteration k so total stiffness ~= k_total.
     const float k_total = 0.6f;                           // try 0.40.8
-    const float k_iter = 1.0f - std::pow(1.0f - k_total, 1.0f / iterations);
-    const float maxCorrFrac = 0.2f;                       // optional safety clamp
+    // k_total was tuned at 120 Hz; a longer step compounds it so the stiffness per second
+    // stays the same (at 60 Hz each pass removes what two 120 Hz passes would)
+    const float stepsPerTunedStep = dt * 120.0f;
+    const float k_iter = 1.0f - std::pow(1.0f - k_total, stepsPerTunedStep / iterations);
+    // safety clamp on one spring's move. At 0.2 big bodies of every mode tangle under hard
+    // punches: body springs at S = 17 (--bench stability, 120 Hz) end up inside out instead
+    // of recovering to 0.85 tall, the volume modes at S = 33 too
+    const float maxCorrFrac = 0.5f;
 
     for (int it = 0; it < iterations; ++it) {
-        for (const auto& s : springs) {
-            auto& a = particles[s.i];
-            auto& b = particles[s.j];
+        if (solverMode == SolverMode::Jacobi) {
+            if (!topo->springEnds16.empty()) jacobiSprings(topo->springEnds16.data(), k_iter, maxCorrFrac);
+            else                             jacobiSprings(topo->springEnds32.data(), k_iter, maxCorrFrac);
+        }
+        else {
+            if (!topo->springEnds16.empty()) projectSprings(topo->springEnds16.data(), k_iter, maxCorrFrac);
+            else                             projectSprings(topo->springEnds32.data(), k_iter, maxCorrFrac);
+        }
+    }
+}
+
+// V = sum over outward triangles (a, b, c) of a . (b x c) / 6, so dV/da = (b x c) / 6 etc.
+float Jelly::computeVolume()
+{
+    const std::vector<int>& tris = topo->volumeTris;
+    volumeGrad.assign(particles.size(), glm::vec3(0.0f));
+    float volume = 0.0f;
+    for (size_t t = 0; t < tris.size(); t += 3) {
+        const int a = tris[t], b = tris[t + 1], c = tris[t + 2];
+        const glm::vec3& pa = particles[a].p;
+        const glm::vec3& pb = particles[b].p;
+        const glm::vec3& pc = particles[c].p;
+        const glm::vec3 bc = glm::cross(pb, pc);
+        volume += glm::dot(pa, bc);
+        volumeGrad[a] += bc;
+        volumeGrad[b] += glm::cross(pc, pa);
+        volumeGrad[c] += glm::cross(pa, pb);
+    }
+    for (auto& g : volumeGrad) g *= 1.0f / 6.0f;
+    return volume / 6.0f;
+}
+
+// PBD projection of C = V - V0: every particle moves along dC/dp by the same
+// lambda = -C / sum(w |dC/dp|^2), which fixes the volume to first order in one go, so Step
+// runs it once, on its last pass. Each move is clamped to half the lattice spacing: after a
+// hard impact the gradient is largest on the crumpled spikes, and moving them the full
+// amount tangles the surface.
+void Jelly::projectVolume()
+{
+    const float volume = computeVolume();
+    if (!(volume > minVolumeRatio * topo->restVolume)) { collapsed = true; return; }
+    const float C = volume - topo->restVolume;
+    float denom = 0.0f;
+    for (size_t i = 0; i < particles.size(); ++i)
+        denom += particles[i].invMass * glm::length2(volumeGrad[i]);
+    if (denom < 1e-12f) return;
+
+    const float lambda = -volumeStiffness * C / denom;
+    const float maxStep = 0.5f * radius / springsPerEdge;
+    for (size_t i = 0; i < particles.size(); ++i) {
+        glm::vec3 dp = lambda * particles[i].invMass * volumeGrad[i];
+        const float len = glm::length(dp);
+        if (len > maxStep) dp *= maxStep / len;
+        particles[i].p += dp;
+    }
+}
+
+// Net pressure p = p0 (V0 / V - 1) pushes on every triangle along its area normal; summed
+// per particle that is exactly p dV/dp, so over a step it moves each particle by
+// dt^2 w p dV/dp. Applied as one explicit force at the start of the step it overshoots
+// whenever dt^2 times the gas stiffness is large (60 Hz, or a body squashed on the floor),
+// and the collider passes that follow can't take the surplus back out. Here it is one
+// implicit (XPBD-style) Newton step on gasImpulse = dt^2 p(V), with V the volume after the
+// move, taken on the last pass like projectVolume and clamped like it. Below
+// minVolumeRatio (or a negative volume: the body is inside out) the gas model means
+// nothing, so that is reported instead of applied.
+void Jelly::projectGasPressure(float dt)
+{
+    const float V0 = topo->restVolume;
+    const float volume = computeVolume();
+    if (!(volume > minVolumeRatio * V0)) { collapsed = true; return; }
+
+    float gradSq = 0.0f;
+    for (size_t i = 0; i < particles.size(); ++i)
+        gradSq += particles[i].invMass * glm::length2(volumeGrad[i]);
+    if (gradSq < 1e-12f) return;
+
+    const float dt2 = dt * dt;
+    const float pressure = gasPressure * (V0 / volume - 1.0f);
+    const float stiffness = gasPressure * V0 / (volume * volume);  // -dp/dV
+    const float delta = (dt2 * pressure - gasImpulse) / (1.0f + dt2 * stiffness * gradSq);
+    gasImpulse += delta;
+
+    const float maxStep = 0.5f * radius / springsPerEdge;
+    for (size_t i = 0; i < particles.size(); ++i) {
+        glm::vec3 dp = delta * particles[i].invMass * volumeGrad[i];
+        const float len = glm::length(dp);
+        if (len > maxStep) dp *= maxStep / len;
+        particles[i].p += dp;
+    }
+}
+
+float Jelly::volumeRatio() const
+{
+    const std::vector<int>& tris = topo->volumeTris;
+    float volume = 0.0f;
+    for (size_t t = 0; t < tris.size(); t += 3)
+        volume += glm::dot(particles[tris[t]].p, glm::cross(particles[tris[t + 1]].p, particles[tris[t + 2]].p));
+    return topo->restVolume > 0.0f ? volume / 6.0f / topo->restVolume : 1.0f;
+}
+
+// One Gauss-Seidel sweep over the springs; Index is the stored endpoint width.
+template <class Index>
+void Jelly::projectSprings(const Index* ends, float k_iter, float maxCorrFrac)
+{
+    const float* rest = topo->springRest.data();
+    const int count = topo->springCount();
+    Particle* P = particles.data();
+
+    for (int s = 0; s < count; ++s) {
+        auto& a = P[ends[2 * s]];
+        auto& b = P[ends[2 * s + 1]];
+
+        glm::vec3 d = b.p - a.p;
+        float l2 = glm::length2(d);
+        if (l2 < 1e-12f) continue;
+
+        float len = std::sqrt(l2);
+        float diff = (len - rest[s]) / len;          // >0 if stretched, <0 if compressed
+        float w1 = a.invMass, w2 = b.invMass, wsum = w1 + w2;
+        if (wsum <= 0.0f) continue;
+
+        // correction along d
+        glm::vec3 corr = d * (k_iter * diff);
+
+        // optional clamp to avoid huge single-step jumps
+        float corrLen = glm::length(corr);
+        float maxStep = maxCorrFrac * rest[s];
+        if (corrLen > maxStep) corr *= (maxStep / std::max(corrLen, 1e-8f));
+
+        // *** FIXED SIGNS ***
+        a.p += (w1 / wsum) * corr;    // move a toward b when stretched
+        b.p -= (w2 / wsum) * corr;    // move b toward a when stretched
+    }
+}
+
+// One Jacobi pass: every spring computes its correction from the same positions, then each
+// particle averages the corrections of its springs. Both loops are free of write conflicts,
+// so with `jobs` set each is split into chunks across threads (bodies below one chunk stay
+// on the calling thread). Chebyshev semi-iterative acceleration (Wang 2015) extrapolates
+// across the passes of one Step.
+template <class Index>
+void Jelly::jacobiSprings(const Index* ends, float k_iter, float maxCorrFrac)
+{
+    const float* rest = topo->springRest.data();
+    const int count = topo->springCount();
+    const int n = (int)particles.size();
+    Particle* P = particles.data();
+    // a chunk is worth a job from a few thousand springs (or their particles) up
+    const int springGrain = 8192, particleGrain = 2048;
+    auto forRange = [&](int size, int grain, const std::function<void(int, int)>& body) {
+        if (jobs) jobs->parallelFor(size, grain, body);
+        else body(0, size);
+    };
+
+    springCorr.resize(2 * (size_t)count);
+    glm::vec3* corrOut = springCorr.data();
+    forRange(count, springGrain, [&](int first, int last) {
+        for (int s = first; s < last; ++s) {
+            const Particle& a = P[ends[2 * s]];
+            const Particle& b = P[ends[2 * s + 1]];
 
             glm::vec3 d = b.p - a.p;
             float l2 = glm::length2(d);
-            if (l2 < 1e-12f) continue;
-
-            float len = std::sqrt(l2);
-            float diff = (len - s.rest) / len;           // >0 if stretched, <0 if compressed
             float w1 = a.invMass, w2 = b.invMass, wsum = w1 + w2;
-            if (wsum <= 0.0f) continue;
+            if (l2 < 1e-12f || wsum <= 0.0f) { corrOut[2 * s] = corrOut[2 * s + 1] = glm::vec3(0.0f); continue; }
 
-            // correction along d
-            glm::vec3 corr = d * (k_iter * diff);
-
-            // optional clamp to avoid huge single-step jumps
+            float len = std::sqrt(l2);
+            glm::vec3 corr = d * (k_iter * (len - rest[s]) / len);
             float corrLen = glm::length(corr);
-            float maxStep = maxCorrFrac * s.rest;
+            float maxStep = maxCorrFrac * rest[s];
             if (corrLen > maxStep) corr *= (maxStep / std::max(corrLen, 1e-8f));
 
-            // *** FIXED SIGNS ***
-            a.p += (w1 / wsum) * corr;    // move a toward b when stretched
-            b.p -= (w2 / wsum) * corr;    // move b toward a when stretched
+            corrOut[2 * s]     =  (w1 / wsum) * corr;
+            corrOut[2 * s + 1] = -(w2 / wsum) * corr;
         }
+        });
+
+    // Chebyshev weights: omega_1 = 1, omega_2 = 2 / (2 - rho^2), omega_k+1 = 4 / (4 - rho^2 omega_k)
+    const float rho2 = chebyshevRho * chebyshevRho;
+    if (chebIter == 0 || chebyshevRho <= 0.0f) chebOmega = 1.0f;
+    else if (chebIter == 1) chebOmega = 2.0f / (2.0f - rho2);
+    else chebOmega = 4.0f / (4.0f - rho2 * chebOmega);
+    if (chebIter == 0) chebPrev.resize(n);
+    ++chebIter;
+
+    const int* adjStart = topo->springAdjStart.data();
+    const int* adj = topo->springAdj.data();
+    glm::vec3* prevIterate = chebPrev.data();
+    const float omega = chebOmega;
+    forRange(n, particleGrain, [&](int first, int last) {
+        for (int i = first; i < last; ++i) {
+            const int e0 = adjStart[i], e1 = adjStart[i + 1];
+            glm::vec3 delta(0.0f);
+            for (int e = e0; e < e1; ++e) delta += corrOut[adj[e]];
+            if (e1 > e0) delta *= jacobiOmega / (float)(e1 - e0);
+
+            const glm::vec3 q = P[i].p;
+            const glm::vec3 relaxed = q + delta;
+            P[i].p = (omega == 1.0f) ? relaxed : omega * (relaxed - prevIterate[i]) + prevIterate[i];
+            prevIterate[i] = q;
+        }
+        });
+}
+
+float Jelly::constraintResidual(float* maxStrain) const
+{
+    double sum = 0.0;
+    float worst = 0.0f;
+    const int count = topo->springCount();
+    for (int s = 0; s < count; ++s) {
+        const float rest = topo->springRest[s];
+        if (rest <= 0.0f) continue;
+        const float strain = std::abs(glm::length(particles[topo->springJ(s)].p - particles[topo->springI(s)].p) - rest) / rest;
+        sum += (double)strain * strain;
+        worst = std::max(worst, strain);
     }
+    if (maxStrain) *maxStrain = worst;
+    return count ? (float)std::sqrt(sum / count) : 0.0f;
 }
 
 
-void Jelly::collideWithContainer(const Container& box)
+void Jelly::applyDrag()
 {
-    const float EPS = 1e-4f;
-    // walls: x in [min.x, max.x], z in [min.z, max.z], y >= min.y (floor), open top
-    for (auto& p : particles) {
-        glm::vec3 cur = p.p;
-        glm::vec3 prev = p.prev;
-
-        // floor
-        if (cur.y < box.min.y) {
-            cur.y = box.min.y + EPS;;
-            glm::vec3 v = cur - prev;
-            v.y = -v.y * (1.0f - box.restitution);
-            v.x *= (1.0f - box.friction);
-            v.z *= (1.0f - box.friction);
-            prev = cur - v;
-        }
-        // x walls
-        if (cur.x < box.min.x) {
-            cur.x = box.min.x + EPS;
-            glm::vec3 v = cur - prev; v.x = -v.x * (1.0f - box.restitution);
-            v.y *= (1.0f - box.friction); v.z *= (1.0f - box.friction);
-            prev = cur - v;
-        }
-        else if (cur.x > box.max.x) {
-            cur.x = box.max.x - EPS;
-            glm::vec3 v = cur - prev; v.x = -v.x * (1.0f - box.restitution);
-            v.y *= (1.0f - box.friction); v.z *= (1.0f - box.friction);
-            prev = cur - v;
-        }
-        // z walls
-        if (cur.z < box.min.z) {
-            cur.z = box.min.z + EPS;
-            glm::vec3 v = cur - prev; v.z = -v.z * (1.0f - box.restitution);
-            v.y *= (1.0f - box.friction); v.x *= (1.0f - box.friction);
-            prev = cur - v;
+    if (dragParticle < 0 || dragParticle >= (int)particles.size()) return;
+    Particle& p = particles[dragParticle];
+    if (p.invMass > 0.0f) p.p += dragStiffness * (dragTarget - p.p);
+}
+
+bool Jelly::raycast(const Ray& ray, float maxT, RayHit& hit) const
+{
+    const std::vector<int>& tris = topo->volumeTris;
+    const Particle* P = particles.data();
+    bool found = false;
+    for (int c = 0; c < topo->patchCount(); ++c) {
+        const int* points = topo->patchPoints.data();
+        glm::vec3 mn = P[points[topo->patchPointStart[c]]].p, mx = mn;
+        for (int k = topo->patchPointStart[c] + 1; k < topo->patchPointStart[c + 1]; ++k) {
+            mn = glm::min(mn, P[points[k]].p);
+            mx = glm::max(mx, P[points[k]].p);
         }
-        else if (cur.z > box.max.z) {
-            cur.z = box.max.z - EPS;
-            glm::vec3 v = cur - prev; v.z = -v.z * (1.0f - box.restitution);
-            v.y *= (1.0f - box.friction); v.x *= (1.0f - box.friction);
-            prev = cur - v;
+        float enter;
+        if (!rayBox(ray, mn, mx, maxT, enter)) continue;   // maxT shrinks with every hit
+
+        for (int k = topo->patchTriStart[c]; k < topo->patchTriStart[c + 1]; ++k) {
+            const int* t = &tris[3 * topo->patchTris[k]];
+            float d, u, v;
+            if (!rayTriangle(ray, P[t[0]].p, P[t[1]].p, P[t[2]].p, maxT, d, u, v)) continue;
+            maxT = d;
+            found = true;
+            hit.triangle = topo->patchTris[k];
+            hit.barycentric = glm::vec3(1.0f - u - v, u, v);
+            hit.t = d;
         }
+    }
+    if (!found) return false;
+
+    hit.point = ray.at(hit.t);
+    const int* t = &tris[3 * hit.triangle];
+    hit.particle = t[0];
+    for (int k = 1; k < 3; ++k)
+        if (glm::distance2(P[t[k]].p, hit.point) < glm::distance2(P[hit.particle].p, hit.point)) hit.particle = t[k];
+    return true;
+}
 
-        p.p = cur; p.prev = prev;
+void Jelly::measure(float dt, const ColliderSet& colliders, BodyStepStats& out) const
+{
+    // PBD springs have no stiffness in physical units (a pass removes a fraction of the
+    // error, whatever the spring), so they show up as strain only, not as energy
+    const float g = 9.81f, mass = pointMass, invDt = dt > 0.0f ? 1.0f / dt : 0.0f;
+    double kinetic = 0.0, potential = 0.0;
+    for (const Particle& p : particles) {
+        if (p.invMass <= 0.0f) continue;
+        kinetic += 0.5 * mass * glm::length2((p.p - p.prev) * invDt);
+        potential += mass * g * p.p.y;
     }
+    float worst = 0.0f;
+    constraintResidual(&worst);
+    out.kinetic = (float)kinetic;
+    out.potential = (float)potential;
+    out.maxStrain = worst;
+    out.residual = solvedResidual;
+
+    thread_local std::vector<ColliderContact> contacts;
+    contacts.clear();
+    colliders.findContacts(particles, aabbMin - touchMargin, aabbMax + touchMargin, touchMargin, contacts);
+    // a particle touching two colliders (in a corner) counts once
+    thread_local std::vector<int> touching;
+    touching.clear();
+    for (const ColliderContact& c : contacts) touching.push_back(c.index);
+    std::sort(touching.begin(), touching.end());
+    out.colliderContacts = (int)(std::unique(touching.begin(), touching.end()) - touching.begin());
+}
+
+void Jelly::sweptBounds(glm::vec3& mn, glm::vec3& mx, float margin) const
+{
+    mn = glm::vec3(1e9f); mx = glm::vec3(-1e9f);
+    for (const auto& p : particles) {
+        mn = glm::min(mn, glm::min(p.p, p.prev));
+        mx = glm::max(mx, glm::max(p.p, p.prev));
+    }
+    if (dragParticle >= 0) { mn = glm::min(mn, dragTarget); mx = glm::max(mx, dragTarget); }
+    mn -= margin; mx += margin;
 }
 
 void Jelly::updateAABB()
@@ -296,29 +435,199 @@ void Jelly::updateAABB()
     aabbMin = mn; aabbMax = mx;
 }
 
-void Jelly::Update(float dt, const Container& box)
+void Jelly::predictedBounds(glm::vec3& mn, glm::vec3& mx) const
+{
+    mn = aabbMin; mx = aabbMax;
+    for (const auto& p : particles) {
+        const glm::vec3 next = 2.0f * p.p - p.prev;
+        mn = glm::min(mn, next);
+        mx = glm::max(mx, next);
+    }
+}
+
+void Jelly::Update(float dt, const ColliderSet& colliders, JellyMeshPool& pool)
+{
+    Step(dt, colliders);
+    UpdateRender(pool);
+}
+
+void Jelly::UpdateRender(JellyMeshPool& pool)
+{
+    rebuildIndicesAndAttributes();
+    updateGPU(pool);
+}
+
+void Jelly::Step(float dt, const ColliderSet& colliders)
 {
+    collapsed = false;
+
+#ifdef JELLY_BENCH_PD
+    if (backend == SolverBackend::ProjectiveDynamics && pointMass > 0.0f) {
+        if (volumeMode == VolumeMode::GasPressure) applyGasPressure();  // explicit, before the solve
+        stepProjectiveDynamics(dt, colliders);
+        if (recordResidual) solvedResidual = constraintResidual();
+        updateAABB();
+        return;
+    }
+#endif
+
     for (auto& p : particles) p.a += acceleration;
     applyGravity();
     integrate(dt);
 
-    const int iters = 4;
-    for (int i = 0; i < iters; ++i) {
-        collideWithContainer(box);   // project onto container planes
-        satisfyConstraints(1);       // then spring projection
+    // colliders whose bounds miss the body this step are skipped; the margin covers what the
+    // solver passes move particles beyond prev/p
+    glm::vec3 bmin, bmax;
+    sweptBounds(bmin, bmax, 0.25f * radius);
+    colliders.collide(particles, bmin, bmax);   // swept: time of impact + bounce
+
+    chebIter = 0; // Chebyshev restarts every step
+    gasImpulse = 0.0f;
+    for (int i = 0; i < solverIterations; ++i) {
+        satisfyConstraints(1, dt);                 // spring projection
+        if (i == solverIterations - 1) {
+            // one volume pass per step: it walks every surface triangle, more than the
+            // spring pass it stands in for
+            if (volumeMode == VolumeMode::Constraint) projectVolume();
+            else if (volumeMode == VolumeMode::GasPressure) projectGasPressure(dt);
+        }
+        applyDrag();
+        colliders.project(particles, bmin, bmax);  // then back out of the colliders
     }
+    if (recordResidual) solvedResidual = constraintResidual();
 
     updateAABB();
-    rebuildIndicesAndAttributes();
-    updateGPU();
 }
 
 
-void Jelly::Render()
+#ifdef JELLY_BENCH_PD
+// Net pressure p0 (V0 / V - 1) pushes on every triangle along its area normal; summed per
+// particle that is exactly pressure * dV/dp. Below minVolumeRatio (or a negative volume:
+// the body is inside out) the gas model means nothing, so it is reported instead of
+// applied; above it the pressure stays within (-p0, 9 p0).
+void Jelly::applyGasPressure()
+{
+    const float volume = computeVolume();
+    if (!(volume > minVolumeRatio * topo->restVolume)) { collapsed = true; return; }
+    const float pressure = gasPressure * (topo->restVolume / volume - 1.0f);
+    for (size_t i = 0; i < particles.size(); ++i)
+        particles[i].a += (pressure * particles[i].invMass) * volumeGrad[i];
+}
+
+// Projective Dynamics step: predict inertially, then alternate a local step (project each
+// spring onto its rest length) with a global step (one prefactored linear solve for all
+// particles). The solve is unconditionally stable, so stiff springs don't need small steps.
+void Jelly::stepProjectiveDynamics(float dt, const ColliderSet& colliders)
+{
+    if (!pd || pd->topo != topo || pd->pointMass != pointMass || pd->dt != dt || pd->stiffness != pdStiffness)
+        pd = PDSystem::Get(topo, pointMass, dt, pdStiffness);
+
+    const float damping = 0.01f; // same mild global damping as integrate()
+    const glm::vec3 accel = acceleration + glm::vec3(0, -9.81f, 0);
+    const int n = (int)particles.size();
+    const int count = topo->springCount();
+
+    pdInertia.resize(n);
+    pdRhs.resize(n);
+    pdX.resize(n);
+    for (int i = 0; i < n; ++i) {
+        Particle& p = particles[i];
+        pdInertia[i] = p.p + (p.p - p.prev) * (1.0f - damping) + (p.a + accel) * (dt * dt);
+        p.prev = p.p;
+        p.p = pdInertia[i];
+        p.a = glm::vec3(0.0f);
+    }
+
+    glm::vec3 bmin, bmax;
+    sweptBounds(bmin, bmax, 0.25f * radius);
+
+    for (int it = 0; it < pdIterations; ++it) {
+        for (int i = 0; i < n; ++i) pdRhs[i] = pd->massOverH2 * pdInertia[i];
+
+        // local step: rest-length edge for every spring, accumulated as w A^T p
+        for (int s = 0; s < count; ++s) {
+            const int i = topo->springI(s), j = topo->springJ(s);
+            glm::vec3 d = particles[j].p - particles[i].p;
+            float len = glm::length(d);
+            glm::vec3 proj = (len > 1e-6f) ? d * (topo->springRest[s] / len) : glm::vec3(0.0f);
+            proj *= pd->weights[s];
+            pdRhs[i] -= proj;
+            pdRhs[j] += proj;
+        }
+
+        // contacts: particles at or past a collider surface are pulled back onto it by a
+        // penalty along its normal, so the global step carries the reaction through the
+        // springs. The system only takes a diagonal term, so the penalty w n n^T is reduced
+        // to its diagonal w (n * n) (exact for axis-aligned surfaces); several contacts on
+        // one particle add up.
+        const float w = pdContactWeight * pd->massOverH2;
+        pdColliderContacts.clear();
+        colliders.findContacts(particles, bmin, bmax, pdContactMargin, pdColliderContacts);
+        pdContacts.clear();
+        pdContactSlot.assign(n, -1);
+        for (const ColliderContact& c : pdColliderContacts) {
+            const glm::vec3 weight = w * c.normal * c.normal;
+            const glm::vec3 target = particles[c.index].p + c.normal * std::max(c.depth, 0.0f);
+            pdRhs[c.index] += weight * target;
+            int& slot = pdContactSlot[c.index];
+            if (slot < 0) {
+                slot = (int)pdContacts.size();
+                pdContacts.push_back({ c.index, glm::vec3(0.0f) });
+            }
+            pdContacts[slot].weight += weight;
+        }
+
+        // the mouse drag is one more penalty of the same kind, on all three axes
+        if (dragParticle >= 0 && dragParticle < n) {
+            const glm::vec3 weight(pdDragWeight * pd->massOverH2);
+            pdRhs[dragParticle] += weight * dragTarget;
+            int& slot = pdContactSlot[dragParticle];
+            if (slot < 0) {
+                slot = (int)pdContacts.size();
+                pdContacts.push_back({ dragParticle, glm::vec3(0.0f) });
+            }
+            pdContacts[slot].weight += weight;
+        }
+
+        // warm-started from the current positions (the previous iterate)
+        for (int i = 0; i < n; ++i) pdX[i] = particles[i].p;
+        pd->solveWithContacts(pdRhs, pdX, pdContacts, pdContactIterations, pdContactTolerance, pdContactWork);
+        for (int i = 0; i < n; ++i) particles[i].p = pdX[i];
+    }
+
+    // The volume constraint isn't part of the constant matrix, so it is projected once on the
+    // result (projecting between iterations fights the global step and blows up).
+    if (volumeMode == VolumeMode::Constraint) projectVolume();
+
+    // whatever penetration the penalty left, plus restitution/friction against the step's
+    // start positions
+    colliders.collide(particles, bmin, bmax);
+}
+#endif
+
+void Jelly::Render(JellyMeshPool& pool)
+{
+    if (!gpuVertices) updateGPU(pool);
+    if (!gpuVertices) return;
+    // no arrays at locations 1 and 4: the same color and first particle for every vertex
+    glVertexAttrib3f(1, color.r, color.g, color.b);
+    if (gpuParticles) glVertexAttribI4i(4, (GLint)gpuParticles.first(), 0, 0, 0);
+    glDrawElementsBaseVertex(GL_TRIANGLES, (GLsizei)gpuIndices.count(), GL_UNSIGNED_INT,
+        (void*)(gpuIndices.first() * sizeof(GLuint)), (GLint)gpuVertices.first());
+}
+
+void Jelly::ReleaseRenderVertices(RenderPath path)
+{
+    gpuVertices.reset();
+    gpuParticles.reset();
+    gpuIndices.reset();
+    renderPath = path;
+    rebuildIndicesAndAttributes();
+}
+
+void Jelly::RenderSprings(SpringOverlay& overlay)
 {
-    vao.Bind();
-    glDrawElements(GL_TRIANGLES, (GLsizei)indices.size(), GL_UNSIGNED_INT, 0);
-    vao.Unbind();
+    if (gpuParticles) overlay.draw(topo, (GLint)gpuParticles.first());
 }
 
 void Jelly::apply_idle_wobble(float t)
@@ -343,14 +652,14 @@ void Jelly::resolve_ground_collision()
     for (auto& p : particles) if (p.p.y < 0.0f) p.p.y = 0.0f;
 }
 
-void Jelly::CollideWith(Jelly& other)
+bool Jelly::CollideWith(Jelly& other)
 {
     glm::vec3 amin = getMin(), amax = getMax();
     glm::vec3 bmin = other.getMin(), bmax = other.getMax();
     bool overlap = (amin.x <= bmax.x && amax.x >= bmin.x) &&
         (amin.y <= bmax.y && amax.y >= bmin.y) &&
         (amin.z <= bmax.z && amax.z >= bmin.z);
-    if (!overlap) return;
+    if (!overlap) return false;
 
     glm::vec3 aCenter = 0.5f * (amin + amax);
     glm::vec3 bCenter = 0.5f * (bmin + bmax);
@@ -369,6 +678,7 @@ void Jelly::CollideWith(Jelly& other)
     for (auto& p : particles)        p.p += delta * push * 0.5f;
     for (auto& p : other.particles)  p.p -= delta * push * 0.5f;
     updateAABB(); other.updateAABB();
+    return true;
 }
 
 
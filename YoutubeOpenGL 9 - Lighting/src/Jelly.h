@@ -1,28 +1,71 @@
 #pragma once
 #include <vector>
+#include <memory>
 #include <glm/glm.hpp>
 #include <glad/glad.h>
-#include "VAO.h"
-#include "VBO.h"
-#include "EBO.h"
-
-struct Container {
-    glm::vec3 min;   // floor corner
-    glm::vec3 max;   // opposite top corner (open top means we only use min.y as floor, max.y for wall height check)
-    float restitution = 0.25f;   // bounciness
-    float friction = 0.6f;
+#include "JellyMeshPool.h"
+#include "JellyTopology.h"
+#ifdef JELLY_BENCH_PD
+#include "ProjectiveDynamics.h"
+#endif
+#include "Particle.h"
+#include "Collider.h"
+#include "Raycast.h"
+#include "Telemetry.h"
+
+class SpringOverlay;
+class JobSystem;
+
+// How satisfyConstraints projects the springs.
+enum class SolverMode {
+    GaussSeidel,   // in place, one spring after another (inherently serial)
+    Jacobi,        // per-spring corrections gathered and averaged per particle, Chebyshev
+                   // accelerated; both halves of a pass split over `jobs` on big bodies
+};
+
+#ifdef JELLY_BENCH_PD
+// How Step advances the body. Projective Dynamics costs several times what Verlet+PBD does at
+// every size (see --bench backend), so it is only built for that benchmark.
+enum class SolverBackend {
+    VerletPBD,           // explicit Verlet + position-based spring projection (wants ~120 Hz)
+    ProjectiveDynamics,  // implicit local/global solve on a prefactored system (30-60 Hz is fine)
+};
+#endif
+
+// What keeps the hollow body from collapsing. Picked at construction (it decides whether the
+// topology carries body springs). The volume modes drop ~12% of the springs and cost about
+// what body springs do; they keep the volume but not the shape, so big bodies settle lower
+// and wider (--bench volume).
+enum class VolumeMode {
+    BodySprings,   // S^2 springs between each pair of opposite faces
+    Constraint,    // one enclosed-volume constraint, projected along its gradient once a step
+    GasPressure,   // isothermal gas inside: pressure on the surface from the volume, solved
+                   // implicitly once a step
 };
 
 class Jelly {
 public:
     Jelly(glm::vec3 center, float radius, glm::vec3 velocity, glm::vec3 acceleration,
-        float pointMass, float springStrength, int springsPerEdge);
-
-    void Update(float dt, const Container& box);
-    void Render();
-
-    // collisions with another jelly (simple AABB push for starters)
-    void CollideWith(Jelly& other);
+        float pointMass, float springStrength, int springsPerEdge, bool reorderParticles = true,
+        VolumeMode volumeMode = VolumeMode::BodySprings);
+
+    void Update(float dt, const ColliderSet& colliders, JellyMeshPool& pool);  // Step + UpdateRender
+    void Step(float dt, const ColliderSet& colliders);    // physics only, no GL calls
+    void UpdateRender(JellyMeshPool& pool);               // BuildRenderVertices + UploadRenderVertices
+    void BuildRenderVertices() { rebuildIndicesAndAttributes(); }  // from the particles; no GL, any thread
+    // GL thread. The first upload takes this body's ranges of the pool (whose path must be
+    // renderPath); they go back when the body is destroyed, so the pool must outlive it.
+    void UploadRenderVertices(JellyMeshPool& pool) { updateGPU(pool); }
+    bool IsUploaded() const { return (bool)gpuVertices; }  // false too when the pool is full
+    // gives the ranges back (before their pool goes) and rebuilds for another path
+    void ReleaseRenderVertices(RenderPath path);
+    void Render(JellyMeshPool& pool);                     // the pool must be bound
+    // the spring network as strain-colored lines, from the uploaded particles
+    // (ParticleBuffer only); between SpringOverlay::begin and end
+    void RenderSprings(SpringOverlay& overlay);
+
+    // collisions with another jelly (simple AABB push for starters); true if they touched
+    bool CollideWith(Jelly& other);
 
     // optional fun stuff you already had
     void apply_idle_wobble(float time);
@@ -32,31 +75,55 @@ public:
     // AABB for broad-phase
     glm::vec3 getMin() const { return aabbMin; }
     glm::vec3 getMax() const { return aabbMax; }
+    // bounds of where the body is and where it is heading (p + (p - prev)), so two bodies
+    // that might touch during the next step have overlapping predicted bounds
+    void predictedBounds(glm::vec3& mn, glm::vec3& mx) const;
+
+    // RMS relative spring strain |len - rest| / rest; maxStrain optionally receives the largest
+    float constraintResidual(float* maxStrain = nullptr) const;
+    // enclosed volume / rest volume
+    float volumeRatio() const;
+    // the last Step found the enclosed volume at or below minVolumeRatio of rest (crushed or
+    // turned inside out), so the volume constraint / gas pressure did nothing that step
+    bool  volumeCollapsed() const { return collapsed; }
+    int   springCount() const { return topo->springCount(); }
+    // energies, strain and collider contacts as they are after a step of dt, and the residual
+    // the last Step recorded (telemetry; step, body, bodyContacts and stepUs are left to the
+    // caller)
+    void measure(float dt, const ColliderSet& colliders, BodyStepStats& out) const;
+
+    // nearest surface hit closer than maxT (hit.body is left alone): the ray is tested
+    // against the topology's patches, bounded from their current particles, and only the
+    // triangles of the patches it enters. Reads the particles only.
+    bool raycast(const Ray& ray, float maxT, RayHit& hit) const;
+
+    // mouse drag: every solver pass pulls one particle toward target (set between steps)
+    void setDrag(int particle, const glm::vec3& target) { dragParticle = particle; dragTarget = target; }
+    void clearDrag() { dragParticle = -1; }
 
 private:
-    struct Particle {
-        glm::vec3 p;       // current
-        glm::vec3 prev;    // previous (for Verlet)
-        glm::vec3 a;       // accumulated accel (gravity etc.)
-        float invMass;     // 1/mass
-    };
-    struct Spring {
-        int i, j;          // particle indices
-        float rest;
-        float k;           // stiffness
-    };
-
-    void GenerateCubeMesh();             // now builds a grid on each face
-    void rebuildIndicesAndAttributes();  // indices/uvs/normals for the current grid layout
-    void updateGPU();                    // push vertex positions to VBO
+    void GenerateCubeMesh();             // places particles on the shared lattice
+    void rebuildIndicesAndAttributes();  // render positions from the particles (the rest is static)
+    void initGPU(JellyMeshPool& pool);   // takes the ranges and fills the static data, on first upload
+    void updateGPU(JellyMeshPool& pool); // push vertex positions to the pool
 
     // physics
     void integrate(float dt);
-    void satisfyConstraints(int iterations);
+    void satisfyConstraints(int iterations, float dt);
+    template <class Index> void projectSprings(const Index* ends, float k_iter, float maxCorrFrac);
+    template <class Index> void jacobiSprings(const Index* ends, float k_iter, float maxCorrFrac);
     void applyGravity();
-    void collideWithContainer(const Container& box);
+    void sweptBounds(glm::vec3& mn, glm::vec3& mx, float margin) const; // around every prev and p
     void updateAABB();
     void dampVel(float factor);
+#ifdef JELLY_BENCH_PD
+    void stepProjectiveDynamics(float dt, const ColliderSet& colliders);
+    void applyGasPressure();             // explicit, ahead of the PD solve
+#endif
+    float computeVolume();               // enclosed volume, gradient into volumeGrad
+    void projectVolume();
+    void projectGasPressure(float dt);
+    void applyDrag();
 
 public:
     glm::vec3 center;
@@ -66,28 +133,85 @@ public:
     float pointMass;            // per particle mass
     float springStrength;       // base k
     int   springsPerEdge;       // divisions along each edge
+    glm::vec3 color = glm::vec3(1.0f, 0.2f, 0.6f);  // vertex color, constant for the draw
+    RenderPath renderPath = RenderPath::ParticleBuffer;  // picked before the first upload
+
+    // solver settings, safe to change between steps
+    SolverMode solverMode = SolverMode::GaussSeidel;
+    int   solverIterations = 4;   // collide + project passes per Step
+    float jacobiOmega = 5.0f;     // over-relaxation of the averaged Jacobi correction
+    float chebyshevRho = 0.81f;   // spectral radius estimate for Chebyshev; 0 disables it
+    JobSystem* jobs = nullptr;    // Jacobi: threads for bodies big enough to split (null: none)
+    bool  recordResidual = false; // telemetry: Step takes constraintResidual after its passes
+
+#ifdef JELLY_BENCH_PD
+    float pdStiffness = 4000.0f;  // spring constant per unit of spring k
+    SolverBackend backend = SolverBackend::VerletPBD;
+    int   pdIterations = 4;       // local/global iterations per Step
+    float pdContactWeight = 30.0f;    // contact penalty, in units of the inertia term m/h^2
+    int   pdContactIterations = 8;    // max CG steps per global solve while anything touches
+    float pdContactTolerance = 1e-3f; // ...stopping once the position error is below this (m RMS)
+    float pdDragWeight = 20.0f;       // drag penalty, in units of the inertia term m/h^2
+#endif
+
+    const VolumeMode volumeMode;
+    float volumeStiffness = 1.0f;  // Constraint: fraction of the volume error removed per pass
+    float gasPressure = 10000.0f;  // GasPressure: pressure (Pa) of the gas at rest volume; the
+                                   // same ambient pressure acts outside, so rest is in balance
+
+    float dragStiffness = 0.3f;    // fraction of the gap to the drag target closed per pass
 
 private:
-    // render buffers (interleaved: pos(3), normal(3), uv(2), color(3) = 11 floats)
-    std::vector<GLfloat> vertices;
-    std::vector<GLuint>  indices;
-    std::vector<GLfloat> originalVertices; // for your wobble/punch toys
-
-    // softbody data
+    // render vertices: only positions change, so they are the only stream re-uploaded each
+    // step, 12 bytes each: one per face vertex (FaceVertices), or one per particle
+    // (ParticleBuffer, where the static stream carries the particle index instead). Normals
+    // and uvs come from the topology and sit in a static stream packed to 8 bytes
+    // (GL_INT_2_10_10_10_REV normal, half-float uv), and the color is a constant attribute
+    // set per draw.
+    std::vector<glm::vec3> renderPositions;
+
+    // softbody data (springs, indices, uvs and the face map live in the shared topology)
+    std::shared_ptr<const JellyTopology> topo;
     std::vector<Particle> particles;
-    std::vector<Spring>   springs;
-    int Nx, Ny, Nz;  // grid points per axis for a cube surface lattice (well duplicate for faces)
 
-    int S = 0; // points per edge = springsPerEdge + 1
-    std::vector<std::vector<int>> facePointIdx; // 6 faces, each S*S entries
+    // Jacobi scratch: correction per spring end, and the Chebyshev q^(k-1) iterate
+    std::vector<glm::vec3> springCorr;
+    std::vector<glm::vec3> chebPrev;
+    int   chebIter = 0;
+    float chebOmega = 1.0f;
+
+    // d(volume)/d(particle position), filled by computeVolume
+    std::vector<glm::vec3> volumeGrad;
+    bool collapsed = false;
+    float gasImpulse = 0.0f;  // dt^2 * pressure applied so far this step (per unit dV/dp)
+    float solvedResidual = 0.0f;  // recordResidual: after the last Step's solver passes
+    static constexpr float minVolumeRatio = 0.1f;  // gas pressure tops out at 9x its rest value
+
+#ifdef JELLY_BENCH_PD
+    // Projective Dynamics: shared prefactored system plus per-body work buffers
+    std::shared_ptr<const PDSystem> pd;
+    std::vector<glm::vec3> pdInertia;  // y = inertial prediction
+    std::vector<glm::vec3> pdRhs;
+    std::vector<glm::vec3> pdX;        // global step iterate: warm start in, solution out
+    std::vector<PDSystem::Contact> pdContacts;
+    std::vector<ColliderContact> pdColliderContacts;
+    std::vector<int> pdContactSlot;    // particle -> its entry in pdContacts, or -1
+    PDSystem::ContactWork pdContactWork;
+    static constexpr float pdContactMargin = 1e-3f;
+#endif
+    static constexpr float touchMargin = 1e-3f;  // this close to a collider counts as a contact
 
     // AABB
     glm::vec3 aabbMin, aabbMax;
 
-    // GL
-    VAO vao;
-    VBO* vbo;
-    EBO* ebo;
+    // mouse drag: the pulled particle (-1: none) and where to
+    int dragParticle = -1;
+    glm::vec3 dragTarget = glm::vec3(0.0f);
+
+    // GL: this body's share of the pool's buffers
+    GpuArena::Range gpuVertices;   // face vertices
+    GpuArena::Range gpuParticles;  // ParticleBuffer: positions
+    GpuArena::Range gpuIndices;
 };
 
 
@@ -0,0 +1,92 @@
+#include "JellyMeshPool.h"
+#include <cstdint>
+#include <cstring>
+#include <glm/glm.hpp>
+
+namespace {
+
+std::vector<GpuArena::Stream> vertexStreams(RenderPath path)
+{
+    if (path == RenderPath::ParticleBuffer)
+        return { { 3 * sizeof(uint32_t), GL_STATIC_DRAW } };
+    return { { sizeof(glm::vec3), GL_DYNAMIC_DRAW }, { 2 * sizeof(uint32_t), GL_STATIC_DRAW } };
+}
+
+} // namespace
+
+JellyMeshPool::JellyMeshPool(RenderPath path_, size_t initialVertices)
+    : path(path_),
+    vertices(vertexStreams(path_), initialVertices),
+    particles({ { sizeof(glm::vec3), GL_DYNAMIC_DRAW } }, path_ == RenderPath::ParticleBuffer ? initialVertices / 2 : 0),
+    indices({ { sizeof(GLuint), GL_STATIC_DRAW } }, 3 * initialVertices / 2)
+{
+    // the arenas keep their buffer names when they grow or compact, so this is linked once;
+    // locations as in default.vert / jelly.vert: 0 pos (or particle index), 1 color, 2 uv, 3 normal
+    vao.Bind();
+    if (path == RenderPath::ParticleBuffer) {
+        const GLsizeiptr stride = 3 * sizeof(uint32_t);
+        const GLuint vbo = vertices.buffer(0);
+        vao.LinkAttrib(vbo, 0, 1, GL_INT, stride, (void*)0, GL_FALSE, true);                           // particle
+        vao.LinkAttrib(vbo, 2, 2, GL_HALF_FLOAT, stride, (void*)(2 * sizeof(uint32_t)));                // uv
+        vao.LinkAttrib(vbo, 3, 4, GL_INT_2_10_10_10_REV, stride, (void*)sizeof(uint32_t), GL_TRUE);     // normal
+    }
+    else {
+        const GLsizeiptr stride = 2 * sizeof(uint32_t);
+        vao.LinkAttrib(vertices.buffer(0), 0, 3, GL_FLOAT, sizeof(glm::vec3), (void*)0);                // pos
+        vao.LinkAttrib(vertices.buffer(1), 2, 2, GL_HALF_FLOAT, stride, (void*)sizeof(uint32_t));       // uv
+        vao.LinkAttrib(vertices.buffer(1), 3, 4, GL_INT_2_10_10_10_REV, stride, (void*)0, GL_TRUE);     // normal
+    }
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indices.buffer(0));
+    vao.Unbind();
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+    if (path == RenderPath::ParticleBuffer) {
+        glGenTextures(1, &positionTex);
+        const int texels = PositionTexels();
+        positionFormat = texels == 1 ? GL_RGB32F : GL_R32F;
+        GLint maxTexels = 0;
+        glGetIntegerv(GL_MAX_TEXTURE_BUFFER_SIZE, &maxTexels);
+        particles.setCapacityLimit((size_t)maxTexels / texels);
+    }
+}
+
+int JellyMeshPool::PositionTexels()
+{
+    static const int texels = [] {
+        GLint major = 0;
+        glGetIntegerv(GL_MAJOR_VERSION, &major);
+        if (major >= 4) return 1;
+        GLint count = 0;
+        glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+        for (GLint i = 0; i < count; ++i) {
+            const char* name = (const char*)glGetStringi(GL_EXTENSIONS, i);
+            if (name && std::strcmp(name, "GL_ARB_texture_buffer_object_rgb32") == 0) return 1;
+        }
+        return 3;
+    }();
+    return texels;
+}
+
+JellyMeshPool::~JellyMeshPool()
+{
+    if (positionTex) glDeleteTextures(1, &positionTex);
+}
+
+void JellyMeshPool::Bind()
+{
+    vao.Bind();
+    if (!positionTex) return;
+    glActiveTexture(GL_TEXTURE0 + positionTextureUnit);
+    glBindTexture(GL_TEXTURE_BUFFER, positionTex);
+    if (attachedGeneration != particles.generation()) {
+        // re-attach after the buffer was respecified, so the texture sees its new size
+        glTexBuffer(GL_TEXTURE_BUFFER, positionFormat, particles.buffer(0));
+        attachedGeneration = particles.generation();
+    }
+    glActiveTexture(GL_TEXTURE0);
+}
+
+void JellyMeshPool::Unbind()
+{
+    vao.Unbind();
+}
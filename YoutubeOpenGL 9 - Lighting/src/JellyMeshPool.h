@@ -0,0 +1,49 @@
+#pragma once
+#include <glad/glad.h>
+#include "GpuArena.h"
+#include "VAO.h"
+
+// How Render feeds the GPU. Picked before the first Render (it decides the GL objects), and
+// each path wants its own vertex shader.
+enum class RenderPath {
+    FaceVertices,    // positions expanded to the 6*S^2 face vertices on the CPU (default.vert)
+    ParticleBuffer,  // only the unique particle positions, in a texture buffer (jelly.vert)
+};
+
+// GPU storage shared by every jelly drawn one way: each jelly holds ranges of these arenas,
+// and all of them draw through the one VAO with glDrawElementsBaseVertex, so adding or
+// removing jellies creates and deletes no GL objects. Must outlive the jellies' ranges.
+class JellyMeshPool {
+public:
+    static constexpr GLint positionTextureUnit = 1;  // ParticleBuffer: unit of jelly.vert's "positions"
+    // texels per particle in the position texture for the current context: 1 where GL_RGB32F
+    // texture buffers exist (GL 4.0 or ARB_texture_buffer_object_rgb32), else 3 GL_R32F ones.
+    // The shaders reading "positions" take it as their "positionTexels" uniform.
+    static int PositionTexels();
+
+    explicit JellyMeshPool(RenderPath path, size_t initialVertices = 1 << 14);
+    ~JellyMeshPool();
+    JellyMeshPool(const JellyMeshPool&) = delete;
+    JellyMeshPool& operator=(const JellyMeshPool&) = delete;
+
+    void Bind();     // the VAO, plus the position texture for ParticleBuffer
+    void Unbind();
+
+    const RenderPath path;
+
+    // per face vertex. FaceVertices: [0] streamed positions, [1] packed normal + uv;
+    // ParticleBuffer: [0] particle index + packed normal + uv
+    GpuArena vertices;
+    // ParticleBuffer: streamed positions, one per particle, read by jelly.vert through a
+    // texture buffer. It never grows past what GL_MAX_TEXTURE_BUFFER_SIZE lets the texture
+    // address (GL 3.3 only guarantees 65536 texels, 21845 particles as GL_R32F); a body that
+    // does not fit then gets no ranges, and PhysicsWorld falls back to FaceVertices.
+    GpuArena particles;
+    GpuArena indices;    // triangles, relative to the jelly's first vertex
+
+private:
+    VAO vao;
+    GLuint positionTex = 0;
+    GLenum positionFormat = GL_R32F;
+    unsigned attachedGeneration = ~0u;  // particles.generation() when positionTex was attached
+};
@@ -0,0 +1,281 @@
+#include "JellyTopology.h"
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <numeric>
+#include <tuple>
+
+namespace {
+struct BuildSpring { int i, j; float rest, k; };
+}
+
+// Maps a face grid point (u, v) onto the cube lattice (i, j, k). Same face layout the
+// renderer has always used: 0 +Z, 1 -Z, 2 +X, 3 -X, 4 +Y, 5 -Y.
+static glm::ivec3 faceToLattice(int f, int u, int v, int S)
+{
+    const int e = S - 1;
+    switch (f) {
+    case 0:  return { u,     v, e     }; // +Z
+    case 1:  return { e - u, v, 0     }; // -Z
+    case 2:  return { e,     v, u     }; // +X
+    case 3:  return { 0,     v, e - u }; // -X
+    case 4:  return { u,     e, v     }; // +Y
+    default: return { u,     0, e - v }; // -Y
+    }
+}
+
+int JellyTopology::surfaceIndex(int S, int i, int j, int k)
+{
+    const int e = S - 1;
+    const int ring = 4 * e;
+    if (j == 0) return k * S + i;
+    if (j == e) return S * S + (S - 2) * ring + k * S + i;
+
+    // walk the perimeter of an interior layer: -Z edge, +X edge, +Z edge, -X edge
+    int r;
+    if (k == 0)      r = i;
+    else if (i == e) r = e + k;
+    else if (k == e) r = 2 * e + (e - i);
+    else             r = 3 * e + (e - k);
+    return S * S + (j - 1) * ring + r;
+}
+
+// Reverse Cuthill-McKee over the spring graph. Returns newIndex[old]. Neighbours are
+// visited by increasing degree starting from a pseudo-peripheral particle, which keeps
+// the two ends of every spring close together in memory.
+static std::vector<int> reverseCuthillMcKee(int n, const std::vector<BuildSpring>& springs)
+{
+    std::vector<int> start(n + 1, 0);
+    for (const auto& s : springs) { ++start[s.i + 1]; ++start[s.j + 1]; }
+    std::partial_sum(start.begin(), start.end(), start.begin());
+    std::vector<int> adj(start[n]), fill(start.begin(), start.end() - 1);
+    for (const auto& s : springs) { adj[fill[s.i]++] = s.j; adj[fill[s.j]++] = s.i; }
+    auto degree = [&](int v) { return start[v + 1] - start[v]; };
+
+    std::vector<int> order, level(n);
+    order.reserve(n);
+    auto bfs = [&](int root) {
+        // plain BFS used to find the particle farthest from root
+        std::fill(level.begin(), level.end(), -1);
+        std::vector<int> q{ root };
+        level[root] = 0;
+        for (size_t h = 0; h < q.size(); ++h)
+            for (int e = start[q[h]]; e < start[q[h] + 1]; ++e)
+                if (level[adj[e]] < 0) { level[adj[e]] = level[q[h]] + 1; q.push_back(adj[e]); }
+        return q.back();
+        };
+
+    std::vector<char> placed(n, 0);
+    std::vector<int> nbrs;
+    for (int seed = 0; seed < n; ++seed) {
+        if (placed[seed]) continue;
+        const int root = bfs(bfs(seed)); // two sweeps give a good pseudo-peripheral start
+        size_t head = order.size();
+        order.push_back(root); placed[root] = 1;
+        for (; head < order.size(); ++head) {
+            const int v = order[head];
+            nbrs.clear();
+            for (int e = start[v]; e < start[v + 1]; ++e)
+                if (!placed[adj[e]]) { placed[adj[e]] = 1; nbrs.push_back(adj[e]); }
+            std::sort(nbrs.begin(), nbrs.end(), [&](int a, int b) { return degree(a) < degree(b); });
+            order.insert(order.end(), nbrs.begin(), nbrs.end());
+        }
+    }
+
+    std::vector<int> newIndex(n);
+    for (int k = 0; k < n; ++k) newIndex[order[k]] = n - 1 - k;
+    return newIndex;
+}
+
+JellyTopology::JellyTopology(int S_, float radius_, float springStrength_, bool reorder, bool bodySprings_)
+    : S(S_), radius(radius_), springStrength(springStrength_), reordered(reorder), bodySprings(bodySprings_)
+{
+    const float half = radius * 0.5f;
+    const float d = radius / (S - 1);
+
+    faceNormals[0] = { 0, 0, 1 };  faceNormals[1] = { 0, 0,-1 };
+    faceNormals[2] = { 1, 0, 0 };  faceNormals[3] = {-1, 0, 0 };
+    faceNormals[4] = { 0, 1, 0 };  faceNormals[5] = { 0,-1, 0 };
+
+    // S^3 lattice minus its (S-2)^3 interior
+    restOffsets.resize(2 * S * S + (S - 2) * 4 * (S - 1));
+    facePointIdx.resize(6 * S * S);
+    for (int f = 0; f < 6; ++f) {
+        for (int v = 0; v < S; ++v) {
+            for (int u = 0; u < S; ++u) {
+                glm::ivec3 l = faceToLattice(f, u, v, S);
+                int idx = surfaceIndex(S, l.x, l.y, l.z);
+                restOffsets[idx] = glm::vec3(-half + l.x * d, -half + l.y * d, -half + l.z * d);
+                facePointIdx[(f * S + v) * S + u] = idx;
+            }
+        }
+    }
+
+    std::vector<BuildSpring> springs;
+    auto addSpring = [&](int a, int b, float k) {
+        if (a == b) return;
+        float rest = glm::length(restOffsets[a] - restOffsets[b]);
+        springs.push_back({ a,b,rest,k });
+        };
+    for (int f = 0; f < 6; ++f) {
+        for (int v = 0; v < S; ++v) {
+            for (int u = 0; u < S; ++u) {
+                int i = facePoint(f, u, v);
+                if (u + 1 < S) addSpring(i, facePoint(f, u + 1, v), springStrength);
+                if (v + 1 < S) addSpring(i, facePoint(f, u, v + 1), springStrength);
+                if (u + 1 < S && v + 1 < S) addSpring(i, facePoint(f, u + 1, v + 1), springStrength * 0.7f);
+                if (u > 0 && v + 1 < S) addSpring(i, facePoint(f, u - 1, v + 1), springStrength * 0.7f);
+            }
+        }
+    }
+
+    // Add body springs between opposite faces to preserve thickness.
+    // Face pairs: 0 <-> 1 (+Z <-> -Z), 2 <-> 3 (+X <-> -X), 4 <-> 5 (+Y <-> -Y)
+    // Because some faces use reversed axes, we mirror (u or v) to match positions.
+    auto addPairSprings = [&](int fA, int fB, bool mirrorU, bool mirrorV, float k) {
+        for (int v = 0; v < S; ++v) {
+            for (int u = 0; u < S; ++u) {
+                int ub = mirrorU ? (S - 1 - u) : u;
+                int vb = mirrorV ? (S - 1 - v) : v;
+                addSpring(facePoint(fA, u, v), facePoint(fB, ub, vb), k);
+            }
+        }
+        };
+
+    // Slightly softer than surface springs so they stabilize without getting too stiff
+    const float bodyK = springStrength * 0.6f;
+    if (bodySprings) {
+        addPairSprings(0, 1, /*mirrorU=*/true,  /*mirrorV=*/false, bodyK); // +Z <-> -Z
+        addPairSprings(2, 3, /*mirrorU=*/true,  /*mirrorV=*/false, bodyK); // +X <-> -X
+        addPairSprings(4, 5, /*mirrorU=*/false, /*mirrorV=*/true, bodyK); // +Y <-> -Y
+    }
+
+    if (reorder) {
+        const std::vector<int> newIndex = reverseCuthillMcKee(particleCount(), springs);
+        std::vector<glm::vec3> offsets(restOffsets.size());
+        for (int i = 0; i < particleCount(); ++i) offsets[newIndex[i]] = restOffsets[i];
+        restOffsets.swap(offsets);
+        for (int& idx : facePointIdx) idx = newIndex[idx];
+        for (auto& sp : springs) {
+            sp.i = newIndex[sp.i]; sp.j = newIndex[sp.j];
+            if (sp.i > sp.j) std::swap(sp.i, sp.j);
+        }
+        std::stable_sort(springs.begin(), springs.end(), [](const BuildSpring& a, const BuildSpring& b) {
+            return a.i != b.i ? a.i < b.i : a.j < b.j;
+            });
+
+        // Deal the sorted list out as 4 interleaved streams. Each stream still walks memory
+        // front to back, but neighbouring springs no longer share a particle, so the
+        // Gauss-Seidel sweep doesn't stall on its own previous write.
+        const size_t lanes = 4, quarter = springs.size() / lanes;
+        std::vector<BuildSpring> dealt;
+        dealt.reserve(springs.size());
+        for (size_t k = 0; k < quarter; ++k)
+            for (size_t l = 0; l < lanes; ++l) dealt.push_back(springs[l * quarter + k]);
+        dealt.insert(dealt.end(), springs.begin() + lanes * quarter, springs.end());
+        springs.swap(dealt);
+    }
+
+    const bool narrow = particleCount() <= 0x10000;
+    if (narrow) springEnds16.reserve(springs.size() * 2);
+    else        springEnds32.reserve(springs.size() * 2);
+    springRest.reserve(springs.size());
+    springK.reserve(springs.size());
+    for (const auto& sp : springs) {
+        if (narrow) { springEnds16.push_back((uint16_t)sp.i); springEnds16.push_back((uint16_t)sp.j); }
+        else        { springEnds32.push_back((uint32_t)sp.i); springEnds32.push_back((uint32_t)sp.j); }
+        springRest.push_back(sp.rest);
+        springK.push_back(sp.k);
+    }
+
+    // particle -> incident spring ends, for gather-style (Jacobi) solves
+    springAdjStart.assign(particleCount() + 1, 0);
+    for (const auto& sp : springs) { ++springAdjStart[sp.i + 1]; ++springAdjStart[sp.j + 1]; }
+    std::partial_sum(springAdjStart.begin(), springAdjStart.end(), springAdjStart.begin());
+    springAdj.resize(springAdjStart.back());
+    std::vector<int> fill(springAdjStart.begin(), springAdjStart.end() - 1);
+    for (int s = 0; s < (int)springs.size(); ++s) {
+        springAdj[fill[springs[s].i]++] = 2 * s;
+        springAdj[fill[springs[s].j]++] = 2 * s + 1;
+    }
+
+    // Render layout: every face keeps its own S*S vertices (flat normals, own uvs).
+    uvs.reserve(vertexCount());
+    indices.reserve(6 * (S - 1) * (S - 1) * 6);
+    for (int f = 0; f < 6; ++f) {
+        const GLuint base = (GLuint)(f * S * S);
+        for (int v = 0; v < S; ++v)
+            for (int u = 0; u < S; ++u)
+                uvs.emplace_back((float)u / (float)(S - 1), (float)v / (float)(S - 1));
+        for (int v = 0; v < S - 1; ++v) {
+            for (int u = 0; u < S - 1; ++u) {
+                GLuint i0 = base + v * S + u;
+                GLuint i1 = base + v * S + (u + 1);
+                GLuint i2 = base + (v + 1) * S + (u + 1);
+                GLuint i3 = base + (v + 1) * S + u;
+                indices.insert(indices.end(), { i0,i1,i2,  i0,i2,i3 });
+            }
+        }
+    }
+
+    // Volume triangles: render vertex r sits on particle facePointIdx[r]. Not every face
+    // is wound the same way on screen, so flip the ones whose normal points inward.
+    volumeTris.reserve(indices.size());
+    restVolume = 0.0f;
+    for (size_t t = 0; t < indices.size(); t += 3) {
+        int a = facePointIdx[indices[t]], b = facePointIdx[indices[t + 1]], c = facePointIdx[indices[t + 2]];
+        const int f = (int)(indices[t] / (S * S));
+        const glm::vec3 n = glm::cross(restOffsets[b] - restOffsets[a], restOffsets[c] - restOffsets[a]);
+        if (glm::dot(n, faceNormals[f]) < 0.0f) std::swap(b, c);
+        volumeTris.insert(volumeTris.end(), { a, b, c });
+        restVolume += glm::dot(restOffsets[a], glm::cross(restOffsets[b], restOffsets[c])) / 6.0f;
+    }
+
+    // Ray query patches: quad (u, v) of face f is triangles 2q and 2q + 1 of the list above,
+    // q = (f * (S-1) + v) * (S-1) + u
+    const int quads = S - 1, tile = 4;
+    patchTriStart.assign(1, 0);
+    patchPointStart.assign(1, 0);
+    for (int f = 0; f < 6; ++f) {
+        for (int v0 = 0; v0 < quads; v0 += tile) {
+            for (int u0 = 0; u0 < quads; u0 += tile) {
+                const int v1 = std::min(v0 + tile, quads), u1 = std::min(u0 + tile, quads);
+                for (int v = v0; v < v1; ++v)
+                    for (int u = u0; u < u1; ++u) {
+                        const int q = (f * quads + v) * quads + u;
+                        patchTris.insert(patchTris.end(), { 2 * q, 2 * q + 1 });
+                    }
+                // face points are distinct particles, so the corners of the quads need no dedup
+                for (int v = v0; v <= v1; ++v)
+                    for (int u = u0; u <= u1; ++u) patchPoints.push_back(facePoint(f, u, v));
+                patchTriStart.push_back((int)patchTris.size());
+                patchPointStart.push_back((int)patchPoints.size());
+            }
+        }
+    }
+}
+
+std::shared_ptr<const JellyTopology> JellyTopology::Get(int springsPerEdge, float radius, float springStrength,
+    bool reorder, bool bodySprings)
+{
+    using Key = std::tuple<int, float, float, bool, bool>;
+    static std::mutex mtx;
+    static std::map<Key, std::weak_ptr<const JellyTopology>> cache;
+
+    const int S = std::max(2, springsPerEdge + 1);
+    const Key key(S, radius, springStrength, reorder, bodySprings);
+
+    std::lock_guard<std::mutex> lock(mtx);
+    // drop the entries of topologies no jelly uses any more, so the cache stays as big as
+    // the set of live ones however many sizes come and go
+    for (auto it = cache.begin(); it != cache.end();) {
+        if (it->second.expired()) it = cache.erase(it);
+        else ++it;
+    }
+    auto& slot = cache[key];
+    if (auto topo = slot.lock()) return topo;
+
+    std::shared_ptr<const JellyTopology> topo(new JellyTopology(S, radius, springStrength, reorder, bodySprings));
+    slot = topo;
+    return topo;
+}
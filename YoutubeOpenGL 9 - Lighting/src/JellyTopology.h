@@ -0,0 +1,79 @@
+#pragma once
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <glad/glad.h>
+
+// Everything about a jelly cube that only depends on its shape: the surface lattice,
+// springs, render indices/uvs and the face -> particle map. Built once per
+// (S, radius, springStrength, reorder, bodySprings) and shared read-only by every Jelly
+// with that shape.
+class JellyTopology {
+public:
+    // Returns the cached topology for this shape, building it on first use.
+    // reorder renumbers particles with reverse Cuthill-McKee and sorts the springs so
+    // the solver walks particle memory mostly front to back (see `--bench layout`).
+    // bodySprings adds the S^2 springs per opposite face pair that keep the body from
+    // collapsing; without them the Jelly has to hold its volume some other way.
+    static std::shared_ptr<const JellyTopology> Get(int springsPerEdge, float radius, float springStrength,
+        bool reorder = true, bool bodySprings = true);
+
+    // Closed-form index of the surface lattice point (i, j, k), each in [0, S-1] with at
+    // least one coordinate on the boundary. Particles are numbered bottom layer (j = 0)
+    // first, then one perimeter ring per interior layer, then the top layer.
+    // This is the particle index only when the topology was built without reordering.
+    static int surfaceIndex(int S, int i, int j, int k);
+
+    int particleCount() const { return (int)restOffsets.size(); }
+    int springCount() const { return (int)springRest.size(); }
+    int vertexCount() const { return 6 * S * S; }
+    int facePoint(int f, int u, int v) const { return facePointIdx[(f * S + v) * S + u]; }
+
+    // endpoints of spring s, whichever index width is in use
+    int springI(int s) const { return springEnds16.empty() ? (int)springEnds32[2 * s] : springEnds16[2 * s]; }
+    int springJ(int s) const { return springEnds16.empty() ? (int)springEnds32[2 * s + 1] : springEnds16[2 * s + 1]; }
+
+    int   S = 0;                // points per edge = springsPerEdge + 1
+    float radius = 0.0f;
+    float springStrength = 0.0f;
+    bool  reordered = false;
+    bool  bodySprings = true;
+
+    std::vector<glm::vec3> restOffsets;  // rest particle positions relative to the body center
+
+    // springs, structure of arrays. Endpoints are stored as (i, j) pairs in 16 bits when
+    // the particle count allows it, otherwise in 32 bits; exactly one of the two is filled.
+    std::vector<uint16_t>  springEnds16;
+    std::vector<uint32_t>  springEnds32;
+    std::vector<float>     springRest;
+    std::vector<float>     springK;
+
+    // springs touching each particle: springAdj[springAdjStart[p] .. springAdjStart[p+1])
+    // holds 2*spring + end, where end is 0 if p is the spring's i and 1 if it is j
+    std::vector<int>       springAdjStart;
+    std::vector<int>       springAdj;
+
+    std::vector<int>       facePointIdx; // 6 faces, each S*S entries, [f][v][u]
+    std::vector<GLuint>    indices;      // triangles over the 6*S*S per-face render vertices
+    std::vector<glm::vec2> uvs;          // per render vertex
+    glm::vec3 faceNormals[6];
+
+    // the render triangles in particle indices, all wound outward, and the volume they
+    // enclose at rest (for the volume constraint / gas pressure)
+    std::vector<int>       volumeTris;
+    float restVolume = 0.0f;
+
+    // the same triangles grouped into patches of up to 4x4 quads of one face, so a ray query
+    // bounds a patch from its few particles and only tests the triangles of patches it
+    // hits: patch c holds triangles patchTris[patchTriStart[c] .. patchTriStart[c+1]) and
+    // touches particles patchPoints[patchPointStart[c] .. patchPointStart[c+1])
+    std::vector<int>       patchTriStart;
+    std::vector<int>       patchTris;
+    std::vector<int>       patchPointStart;
+    std::vector<int>       patchPoints;
+    int patchCount() const { return (int)patchTriStart.size() - 1; }
+
+private:
+    JellyTopology(int S, float radius, float springStrength, bool reorder, bool bodySprings);
+};
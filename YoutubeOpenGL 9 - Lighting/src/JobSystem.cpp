@@ -0,0 +1,164 @@
+#include "JobSystem.h"
+#include <algorithm>
+#include "Tracer.h"
+
+namespace {
+
+// which system's worker this thread is, and its deque
+thread_local const JobSystem* tlsSystem = nullptr;
+thread_local int tlsIndex = -1;
+
+} // namespace
+
+JobSystem::JobSystem(int threads)
+{
+    if (threads <= 0) threads = (int)std::max(1u, std::thread::hardware_concurrency());
+    for (int i = 0; i < threads; ++i) queues.emplace_back(new Queue()); // threads - 1 workers + shared
+    for (int i = 0; i + 1 < threads; ++i) workers.emplace_back(&JobSystem::workerLoop, this, i);
+}
+
+JobSystem::~JobSystem()
+{
+    {
+        std::lock_guard<std::mutex> lock(sleepMtx);
+        quit = true;
+    }
+    wake.notify_all();
+    for (std::thread& t : workers) t.join();
+}
+
+JobSystem& JobSystem::Shared()
+{
+    static JobSystem shared;
+    return shared;
+}
+
+int JobSystem::currentQueue() const
+{
+    return tlsSystem == this ? tlsIndex : (int)workers.size();
+}
+
+void JobSystem::push(Handle job)
+{
+    Queue& q = *queues[currentQueue()];
+    {
+        std::lock_guard<std::mutex> lock(q.mtx);
+        q.jobs.push_back(std::move(job));
+    }
+    queued.fetch_add(1);
+    // a sleeper registers before it checks `queued`, so one of the two sides sees the other
+    if (sleepers.load() > 0) {
+        std::lock_guard<std::mutex> lock(sleepMtx);
+        wake.notify_one();
+    }
+}
+
+JobSystem::Handle JobSystem::spawn(std::function<void()> fn, const std::vector<Handle>& after)
+{
+    Handle job = std::make_shared<Job>();
+    job->fn = std::move(fn);
+    for (const Handle& dep : after) {
+        if (!dep) continue;
+        std::lock_guard<std::mutex> lock(dep->mtx);
+        if (dep->finished.load()) continue;
+        job->pending.fetch_add(1);
+        dep->continuations.push_back(job);
+    }
+    if (job->pending.fetch_sub(1) == 1) push(job);
+    return job;
+}
+
+void JobSystem::execute(const Handle& job)
+{
+    job->fn();
+    job->fn = nullptr; // drop the captures now, not whenever the last handle goes
+
+    std::vector<Handle> next;
+    {
+        std::lock_guard<std::mutex> lock(job->mtx);
+        job->finished.store(true, std::memory_order_release);
+        next.swap(job->continuations);
+    }
+    for (Handle& n : next)
+        if (n->pending.fetch_sub(1) == 1) push(std::move(n));
+}
+
+bool JobSystem::runOne()
+{
+    const int self = currentQueue();
+    const int count = (int)queues.size();
+    Handle job;
+
+    // own deque from the back...
+    {
+        Queue& q = *queues[self];
+        std::lock_guard<std::mutex> lock(q.mtx);
+        if (!q.jobs.empty()) {
+            job = std::move(q.jobs.back());
+            q.jobs.pop_back();
+        }
+    }
+    // ...everyone else's from the front
+    for (int k = 1; !job && k < count; ++k) {
+        Queue& q = *queues[(self + k) % count];
+        std::lock_guard<std::mutex> lock(q.mtx);
+        if (!q.jobs.empty()) {
+            job = std::move(q.jobs.front());
+            q.jobs.pop_front();
+        }
+    }
+    if (!job) return false;
+
+    queued.fetch_sub(1);
+    execute(job);
+    return true;
+}
+
+void JobSystem::wait(const Handle& job)
+{
+    if (!job) return;
+    helpUntil([&] { return job->finished.load(std::memory_order_acquire); });
+}
+
+void JobSystem::parallelFor(int count, int grain, const std::function<void(int begin, int end)>& body)
+{
+    if (count <= 0) return;
+    if (grain <= 0) grain = std::max(1, count / (8 * threadCount()));
+    if (workers.empty() || count <= grain) {
+        body(0, count);
+        return;
+    }
+
+    std::atomic<int> remaining{ count };
+    std::function<void(int, int)> run = [&](int begin, int end) {
+        // hand the upper half to the deque until what is left fits one chunk
+        while (end - begin > grain) {
+            const int mid = begin + (end - begin) / 2;
+            spawn([&run, mid, end] { run(mid, end); });
+            end = mid;
+        }
+        body(begin, end);
+        remaining.fetch_sub(end - begin, std::memory_order_release);
+        };
+    run(0, count);
+    helpUntil([&] { return remaining.load(std::memory_order_acquire) == 0; });
+}
+
+void JobSystem::workerLoop(int index)
+{
+    tlsSystem = this;
+    tlsIndex = index;
+    Tracer::Shared().setThreadName("worker " + std::to_string(index + 1));
+    while (!quit.load()) {
+        if (runOne()) continue;
+
+        // nothing anywhere: spin briefly in case more is on the way, then sleep
+        for (int spin = 0; spin < 64 && queued.load() == 0 && !quit.load(); ++spin) std::this_thread::yield();
+        if (queued.load() > 0) continue;
+
+        std::unique_lock<std::mutex> lock(sleepMtx);
+        sleepers.fetch_add(1);
+        wake.wait(lock, [this] { return quit.load() || queued.load() > 0; });
+        sleepers.fetch_sub(1);
+    }
+}
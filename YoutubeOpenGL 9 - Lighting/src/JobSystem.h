@@ -0,0 +1,82 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Work-stealing job system. Every worker thread owns a deque: it pushes and pops its own
+// jobs at the back (newest first, still warm in cache) and, when that runs dry, steals the
+// oldest job from the front of someone else's. Threads that are not workers (the GL thread,
+// loaders) share one extra deque.
+//
+// Waiting never blocks a thread that could be working: wait() and parallelFor() run queued
+// jobs until what they wait for is done ("help while waiting"), so they are safe to call
+// from inside a job too.
+class JobSystem {
+public:
+    struct Job;
+    using Handle = std::shared_ptr<Job>;
+
+    // threads counts the calling thread, which helps whenever it waits; 0 means one per
+    // hardware thread
+    explicit JobSystem(int threads = 0);
+    ~JobSystem();
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    // process-wide instance with one thread per hardware thread
+    static JobSystem& Shared();
+
+    int threadCount() const { return (int)workers.size() + 1; }
+
+    // Queues fn to run once every job in `after` has finished (null handles are ignored).
+    Handle spawn(std::function<void()> fn, const std::vector<Handle>& after = {});
+
+    // Returns once the job has finished, running other jobs meanwhile.
+    void wait(const Handle& job);
+
+    // Calls body(begin, end) over [0, count) in chunks of at most `grain` items (0 picks
+    // about eight chunks per thread) and returns once all have run. The range is split in
+    // halves, so idle threads steal big pieces first.
+    void parallelFor(int count, int grain, const std::function<void(int begin, int end)>& body);
+
+    // Runs queued jobs on the calling thread until done() returns true.
+    template <class Done> void helpUntil(Done done)
+    {
+        while (!done())
+            if (!runOne()) std::this_thread::yield();
+    }
+
+private:
+    struct alignas(64) Queue {
+        std::mutex mtx;
+        std::deque<Handle> jobs;
+    };
+
+    void push(Handle job);
+    bool runOne();                  // one queued job, own deque first; false if none found
+    void execute(const Handle& job);
+    void workerLoop(int index);
+    int  currentQueue() const;      // this thread's deque
+
+    std::vector<std::unique_ptr<Queue>> queues;  // one per worker, then the shared one
+    std::vector<std::thread> workers;
+
+    std::atomic<int>  queued{ 0 };    // jobs sitting in some deque
+    std::atomic<int>  sleepers{ 0 };
+    std::atomic<bool> quit{ false };
+    std::mutex sleepMtx;
+    std::condition_variable wake;
+};
+
+struct JobSystem::Job {
+    std::function<void()> fn;
+    std::atomic<int>  pending{ 1 };   // unfinished dependencies, plus one while spawning
+    std::atomic<bool> finished{ false };
+    std::mutex mtx;                    // guards continuations against finishing
+    std::vector<Handle> continuations; // jobs waiting on this one
+};
@@ -3,6 +3,11 @@
 namespace fs = std::filesystem;
 //------------------------------
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
 #include <iostream>
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
@@ -17,52 +22,101 @@ namespace fs = std::filesystem;
 #include "VBO.h"
 #include "EBO.h"
 #include "Jelly.h"
+#include "PhysicsWorld.h"
+#include "StaticMesh.h"
+#include "Frustum.h"
+#include "ShadowMap.h"
+#include "ClusteredLights.h"
+#include "OitPass.h"
+#include "FrameCapture.h"
+#include "HeadlessContext.h"
+#include "GpuTimer.h"
+#include "DynamicResolution.h"
+#include "FramePacer.h"
+#include "Raycast.h"
+#include "SpringOverlay.h"
+#include "Telemetry.h"
+#include "Tracer.h"
+#include "GpuTrace.h"
+#include "JobSystem.h"
 #include "Camera.h"
-
-const unsigned int width = 800;
-const unsigned int height = 800;
-
-// Simple quad helper (pos, color, uv, normal) = 11 floats
-struct QuadGeo {
-    std::vector<GLfloat> v;
-    std::vector<GLuint>  i;
-    VAO vao; VBO* vbo = nullptr; EBO* ebo = nullptr;
-    void build() {
-        vao.Bind();
-        vbo = new VBO(v.data(), (GLsizeiptr)(v.size() * sizeof(GLfloat)));
-        ebo = new EBO(i.data(), (GLsizeiptr)(i.size() * sizeof(GLuint)));
-        vao.LinkAttrib(*vbo, 0, 3, GL_FLOAT, 11 * sizeof(float), (void*)0);                 // pos
-        vao.LinkAttrib(*vbo, 1, 3, GL_FLOAT, 11 * sizeof(float), (void*)(3 * sizeof(float))); // color
-        vao.LinkAttrib(*vbo, 2, 2, GL_FLOAT, 11 * sizeof(float), (void*)(6 * sizeof(float))); // uv
-        vao.LinkAttrib(*vbo, 3, 3, GL_FLOAT, 11 * sizeof(float), (void*)(8 * sizeof(float))); // normal
-        vao.Unbind(); vbo->Unbind(); ebo->Unbind();
-    }
-    void draw() { vao.Bind(); glDrawElements(GL_TRIANGLES, (GLsizei)i.size(), GL_UNSIGNED_INT, 0); vao.Unbind(); }
+#include "Benchmarks.h"
+
+// How RunScene presents its frames: into a window until it closes, or headless (no window)
+// for a fixed number of frames on a fixed 60 Hz clock, so runs are repeatable.
+struct RunOptions {
+    int width = 800, height = 800;
+    int frames = 0;                   // 0: until the window closes (headless needs a count)
+    FrameCapture* capture = nullptr;  // gets every finished frame
+    double targetGpuMs = 0.0;         // > 0: scale the internal resolution to hold this GPU frame time
+    FramePacer* pacer = nullptr;      // window only: when frames start (null: as fast as possible)
+    bool springs = false;             // start with the spring network overlay on (N toggles it)
+    Telemetry* telemetry = nullptr;   // gets per step, per body simulation stats
+    std::string tracePath;            // window only: where T writes the timeline (tracing on)
 };
 
-int main() {
-    // Init GLFW / context
-    glfwInit();
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
-    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-    GLFWwindow* window = glfwCreateWindow(width, height, "Jelly Cubes", NULL, NULL);
-    if (!window) { std::cout << "Failed to create GLFW window\n"; glfwTerminate(); return -1; }
-    glfwMakeContextCurrent(window);
-    gladLoadGL();
-    glViewport(0, 0, width, height);
-    glEnable(GL_DEPTH_TEST);
+// Timeline tracing (--trace): on for the whole run, this thread named, written at exit or on T.
+static void StartTrace(const std::string& path) {
+    if (path.empty()) return;
+    Tracer::Shared().setThreadName("main");
+    Tracer::Shared().setEnabled(true);
+}
+
+static void WriteTrace(const std::string& path) {
+    if (path.empty()) return;
+    if (Tracer::Shared().write(path)) std::cerr << "trace written to " << path << "\n";
+    else std::cerr << "could not write the trace to " << path << "\n";
+}
+
+// Builds the scene, runs the frame loop, and frees it all again. window is null when headless.
+static void RunScene(GLFWwindow* window, const RunOptions& options) {
+    const int width = options.width, height = options.height;
+    // Decode the textures on job threads while the GL thread compiles shaders and builds geometry
+    JobSystem& jobs = JobSystem::Shared();
+    std::string parentDir = (fs::current_path().fs::path::parent_path()).string();
+    std::string texPath = "/Resources/";
+    const std::string brickFile = parentDir + texPath + "brick.png", jellyFile = parentDir + texPath + "slime.png";
+    TextureImage brickImg, jellyImg;
+    JobSystem::Handle brickJob = jobs.spawn([&] { brickImg = TextureImage::Decode(brickFile.c_str()); });
+    JobSystem::Handle jellyJob = jobs.spawn([&] { jellyImg = TextureImage::Decode(jellyFile.c_str()); });
 
     // Shaders
     Shader shader("default.vert", "default.frag");   // used for everything textured/lit
     Shader lightShader("light.vert", "light.frag");  // small light cube
+    Shader jellyShader("jelly.vert", "default.frag"); // jellies: positions fetched from a texture buffer
+    Shader staticDepthShader("default.vert", "shadow.frag"); // shadow map passes: depth only
+    Shader jellyDepthShader("jelly.vert", "shadow.frag");
+    // jellies once the world falls back to face vertices (staticDepthShader casts their shadows)
+    Shader jellyFaceShader("default.vert", "default.frag");
+    // Translucent jellies: weighted blended OIT, so they draw in any order without sorting
+    OitPass oit(width, height);
+    // Dynamic resolution: the internal size follows the measured GPU time of each frame
+    const bool dynamicResolution = options.targetGpuMs > 0.0;
+    GpuTimer gpuTimer;
+    DynamicResolution resolution(options.targetGpuMs);
+    // The GPU's side of the timeline (only queried while the tracer records)
+    GpuTrace gpuTrace;
+    const float jellyOpacity = 0.6f;
+    // Debug: the jellies' springs as lines colored by strain, drawn over the finished image
+    SpringOverlay springOverlay;
+    bool showSprings = options.springs;
 
     // Camera
     Camera camera(width, height, glm::vec3(0.0f, 0.5f, 0.9f));
+    const float fov = 45.0f, nearPlane = 0.1f, farPlane = 100.0f;
 
     // Light
     glm::vec4 lightColor = glm::vec4(1, 1, 1, 1);
     glm::vec3 lightPos = glm::vec3(0.8f, 1.0f, 0.8f);
+    // Shadows from the light looking down into the box (wide enough to see the whole floor)
+    ShadowMap shadows;
+    shadows.setLight(lightPos, glm::vec3(0.0f, 0.0f, 0.0f), 130.0f, 0.05f, 5.0f);
+    // Point lights on top of it: a glow inside every jelly and a swarm of small fireflies,
+    // binned into view-space clusters every frame so each fragment only loops over its own
+    ClusteredLights pointLights;
+    std::vector<PointLight> lightList;
+    const int fireflyCount = 200;
+    const float clusterFar = 5.0f;   // cluster slices end here, a little beyond the box
     // Tiny light cube geo
     GLfloat lightVerts[] = { -0.05f,-0.05f, 0.05f, -0.05f,-0.05f,-0.05f, 0.05f,-0.05f,-0.05f, 0.05f,-0.05f, 0.05f,
                              -0.05f, 0.05f, 0.05f, -0.05f, 0.05f,-0.05f, 0.05f, 0.05f,-0.05f, 0.05f, 0.05f, 0.05f };
@@ -77,10 +131,16 @@ int main() {
     lightVBO.Unbind();
 
     // Textures (both use sampler "tex0" at unit 0; we bind the one we need before drawing)
-    std::string parentDir = (fs::current_path().fs::path::parent_path()).string();
-    std::string texPath = "/Resources/";
-    Texture brickTex((parentDir + texPath + "brick.png").c_str(), GL_TEXTURE_2D, GL_TEXTURE0, GL_RGBA, GL_UNSIGNED_BYTE);
-    Texture jellyTex((parentDir + texPath + "slime.png").c_str(), GL_TEXTURE_2D, GL_TEXTURE0, GL_RGB, GL_UNSIGNED_BYTE);
+    jobs.wait(brickJob);
+    jobs.wait(jellyJob);
+    Texture brickTex(brickImg, GL_TEXTURE_2D, GL_TEXTURE0, GL_RGBA, GL_UNSIGNED_BYTE);
+    Texture jellyTex(jellyImg, GL_TEXTURE_2D, GL_TEXTURE0, GL_RGB, GL_UNSIGNED_BYTE);
+    brickImg.Free();
+    jellyImg.Free();
+    jellyTex.texUnit(jellyFaceShader, "tex0", 0);
+    jellyTex.texUnit(jellyShader, "tex0", 0);
+    glUniform1i(glGetUniformLocation(jellyShader.ID, "positions"), JellyMeshPool::positionTextureUnit);
+    glUniform1i(glGetUniformLocation(jellyShader.ID, "positionTexels"), JellyMeshPool::PositionTexels());
     brickTex.texUnit(shader, "tex0", 0); // set once; well bind brickTex or jellyTex on unit 0 before draw
 
     // Container (open top)
@@ -89,34 +149,21 @@ int main() {
     box.max = glm::vec3(+1.0f, 1.2f, +1.0f);
     box.restitution = 0.25f;
     box.friction = 0.6f;
+    PhysicsWorld world(ColliderSet{ box });   // owns the bodies and the colliders
+    world.telemetry = options.telemetry;
 
     // Two jelly cubes  lighter mesh + gentle springs (PoC-friendly)
-    Jelly j1(glm::vec3(0.00f, 0.70f, 0.00f), 0.35f, glm::vec3(0), glm::vec3(0), 0.05f, 0.25f, 2);
-    Jelly j2(glm::vec3(0.22f, 0.95f, 0.00f), 0.35f, glm::vec3(0), glm::vec3(0), 0.05f, 0.25f, 2);
-
-
-    // Build brick floor and 4 brick walls as world-space quads
-    auto makeQuad = [](glm::vec3 p0, glm::vec3 p1, glm::vec3 p2, glm::vec3 p3, glm::vec3 n,
-        float uTiles, float vTiles) {
-            QuadGeo q;
-            glm::vec3 col(1.0f, 1.0f, 1.0f); // color is mostly unused by the fragment shader (texture dominates)
-            // v0
-            q.v.insert(q.v.end(), { p0.x,p0.y,p0.z,  col.x,col.y,col.z,  0.0f,      0.0f,      n.x,n.y,n.z });
-            // v1
-            q.v.insert(q.v.end(), { p1.x,p1.y,p1.z,  col.x,col.y,col.z,  uTiles,    0.0f,      n.x,n.y,n.z });
-            // v2
-            q.v.insert(q.v.end(), { p2.x,p2.y,p2.z,  col.x,col.y,col.z,  uTiles,    vTiles,    n.x,n.y,n.z });
-            // v3
-            q.v.insert(q.v.end(), { p3.x,p3.y,p3.z,  col.x,col.y,col.z,  0.0f,      vTiles,    n.x,n.y,n.z });
-            q.i = { 0,1,2, 0,2,3 };
-            q.build();
-            return q;
-        };
+    world.add(std::make_unique<Jelly>(glm::vec3(0.00f, 0.70f, 0.00f), 0.35f, glm::vec3(0), glm::vec3(0), 0.05f, 0.25f, 2));
+    world.add(std::make_unique<Jelly>(glm::vec3(0.22f, 0.95f, 0.00f), 0.35f, glm::vec3(0), glm::vec3(0), 0.05f, 0.25f, 2));
 
+    // Brick floor and 4 brick walls, merged with any other static pieces into one mesh per
+    // material (cached next to the textures; rebuilt whenever the pieces change)
+    enum StaticMaterial { Brick };
+    StaticMeshBuilder scene;
     const float tileU = 6.0f, tileV = 6.0f; // repeat bricks nicely
 
     // Floor (y = box.min.y), normal +Y
-    QuadGeo floor = makeQuad(
+    scene.addQuad(Brick,
         glm::vec3(box.min.x, box.min.y, box.max.z),
         glm::vec3(box.max.x, box.min.y, box.max.z),
         glm::vec3(box.max.x, box.min.y, box.min.z),
@@ -124,7 +171,7 @@ int main() {
         glm::vec3(0, 1, 0), tileU, tileV);
 
     // +X wall (right), normal pointing -X
-    QuadGeo wallPosX = makeQuad(
+    scene.addQuad(Brick,
         glm::vec3(box.max.x, box.min.y, box.min.z),
         glm::vec3(box.max.x, box.min.y, box.max.z),
         glm::vec3(box.max.x, box.max.y, box.max.z),
@@ -132,7 +179,7 @@ int main() {
         glm::vec3(-1, 0, 0), tileU, tileV);
 
     // -X wall (left), normal +X
-    QuadGeo wallNegX = makeQuad(
+    scene.addQuad(Brick,
         glm::vec3(box.min.x, box.min.y, box.max.z),
         glm::vec3(box.min.x, box.min.y, box.min.z),
         glm::vec3(box.min.x, box.max.y, box.min.z),
@@ -140,7 +187,7 @@ int main() {
         glm::vec3(1, 0, 0), tileU, tileV);
 
     // +Z wall (front), normal -Z
-    QuadGeo wallPosZ = makeQuad(
+    scene.addQuad(Brick,
         glm::vec3(box.min.x, box.min.y, box.max.z),
         glm::vec3(box.max.x, box.min.y, box.max.z),
         glm::vec3(box.max.x, box.max.y, box.max.z),
@@ -148,13 +195,16 @@ int main() {
         glm::vec3(0, 0, -1), tileU, tileV);
 
     // -Z wall (back), normal +Z
-    QuadGeo wallNegZ = makeQuad(
+    scene.addQuad(Brick,
         glm::vec3(box.max.x, box.min.y, box.min.z),
         glm::vec3(box.min.x, box.min.y, box.min.z),
         glm::vec3(box.min.x, box.max.y, box.min.z),
         glm::vec3(box.max.x, box.max.y, box.min.z),
         glm::vec3(0, 0, 1), tileU, tileV);
 
+    StaticMesh staticScene = scene.buildCached(parentDir + texPath + "static_scene.bin");
+    staticScene.Upload();
+
     // Set static uniforms
     glm::mat4 I(1.0f);
     lightShader.Activate();
@@ -167,68 +217,350 @@ int main() {
     glUniform3f(glGetUniformLocation(shader.ID, "lightPos"), lightPos.x, lightPos.y, lightPos.z);
     glUniformMatrix4fv(glGetUniformLocation(shader.ID, "model"), 1, GL_FALSE, glm::value_ptr(I));
 
-    // Fixed-timestep physics
-    double prevTime = glfwGetTime();
-    double accumulator = 0.0;
-    const double fixedDt = 1.0 / 120.0;
+    for (Shader* jelly : { &jellyShader, &jellyFaceShader }) {
+        jelly->Activate();
+        glUniform4f(glGetUniformLocation(jelly->ID, "lightColor"), lightColor.x, lightColor.y, lightColor.z, lightColor.w);
+        glUniform3f(glGetUniformLocation(jelly->ID, "lightPos"), lightPos.x, lightPos.y, lightPos.z);
+        glUniformMatrix4fv(glGetUniformLocation(jelly->ID, "model"), 1, GL_FALSE, glm::value_ptr(I));
+        glUniform1f(glGetUniformLocation(jelly->ID, "opacity"), jellyOpacity);
+    }
 
-    while (!glfwWindowShouldClose(window)) {
-        glClearColor(0.07f, 0.13f, 0.17f, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    // Both lit shaders sample the two shadow layers; the depth passes draw from the light
+    const glm::mat4& lightMatrix = shadows.lightMatrix();
+    for (Shader* lit : { &shader, &jellyShader, &jellyFaceShader }) {
+        lit->Activate();
+        glUniformMatrix4fv(glGetUniformLocation(lit->ID, "lightMatrix"), 1, GL_FALSE, glm::value_ptr(lightMatrix));
+        glUniform1i(glGetUniformLocation(lit->ID, "shadowStatic"), ShadowMap::staticTextureUnit);
+        glUniform1i(glGetUniformLocation(lit->ID, "shadowDynamic"), ShadowMap::dynamicTextureUnit);
+    }
+    for (Shader* depth : { &staticDepthShader, &jellyDepthShader }) {
+        depth->Activate();
+        glUniformMatrix4fv(glGetUniformLocation(depth->ID, "camMatrix"), 1, GL_FALSE, glm::value_ptr(lightMatrix));
+        glUniformMatrix4fv(glGetUniformLocation(depth->ID, "model"), 1, GL_FALSE, glm::value_ptr(I));
+    }
+    glUniform1i(glGetUniformLocation(jellyDepthShader.ID, "positions"), JellyMeshPool::positionTextureUnit);
+    glUniform1i(glGetUniformLocation(jellyDepthShader.ID, "positionTexels"), JellyMeshPool::PositionTexels());
+
+    // Fixed-timestep physics. 60 Hz holds up to drops and punches (--bench stability) for
+    // every volume mode only up to S = 9, which covers the demo's S = 3 bodies; bigger
+    // body-spring cubes shear flat under punches at 120 Hz as well
+    const double fixedDt = 1.0 / 60.0;
+    double prevTime = window ? glfwGetTime() : 0.0;
+    double accumulator = 0.0;
 
-        camera.Inputs(window);
-        camera.updateMatrix(45.0f, 0.1f, 100.0f);
+    auto running = [&](int frame) {
+        if (options.frames > 0 && frame >= options.frames) return false;
+        return window == nullptr || !glfwWindowShouldClose(window);
+    };
+    double nextReport = prevTime + 1.0;
+    bool rightWasDown = false, toggleWasDown = false, traceWasDown = false;
+    for (int frame = 0; running(frame); ++frame) {
+        Tracer::Scope traceFrame("frame", frame);
+        if (window) {
+            if (glfwGetWindowAttrib(window, GLFW_ICONIFIED)) {
+                // minimized: nothing to show, so sleep on events rather than render
+                glfwWaitEventsTimeout(0.25);
+                prevTime = glfwGetTime();
+                continue;
+            }
+            // input as late as the pacer allows, right before it is used
+            if (options.pacer) {
+                Tracer::Scope trace("wait");
+                options.pacer->waitForInput();
+            }
+            glfwPollEvents();
+            camera.Inputs(window);
+        }
+        Tracer::Scope traceInput("input");
+        camera.updateMatrix(fov, nearPlane, farPlane);
+        const Frustum view = Frustum::FromMatrix(camera.cameraMatrix);
+
+        // right mouse button: grab the jelly under the cursor and drag it around, keeping the
+        // distance it was grabbed at
+        if (window) {
+            double mouseX, mouseY;
+            glfwGetCursorPos(window, &mouseX, &mouseY);
+            const Ray mouseRay = Ray::FromScreen(camera.cameraMatrix, mouseX, mouseY, width, height);
+            const bool rightDown = glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_RIGHT) == GLFW_PRESS;
+            RayHit hit;
+            if (rightDown && !rightWasDown && world.raycast(mouseRay, farPlane, hit)) world.grab(hit);
+            else if (rightDown) world.drag(mouseRay);
+            else world.release();
+            rightWasDown = rightDown;
+
+            const bool toggleDown = glfwGetKey(window, GLFW_KEY_N) == GLFW_PRESS;
+            if (toggleDown && !toggleWasDown) showSprings = !showSprings;
+            toggleWasDown = toggleDown;
+
+            // T: write the timeline so far (it keeps recording)
+            const bool traceDown = glfwGetKey(window, GLFW_KEY_T) == GLFW_PRESS;
+            if (traceDown && !traceWasDown) WriteTrace(options.tracePath);
+            traceWasDown = traceDown;
+        }
+        traceInput.end();
 
-        // Step physics
-        double t = glfwGetTime();
+        // Step physics (headless: exactly one step per frame)
+        double t = window ? glfwGetTime() : (frame + 1) * fixedDt;
         accumulator += (t - prevTime);
         prevTime = t;
 
         // fun: space bar to "punch" both jelly cubes
         // if (glfwGetKey(window, GLFW_KEY_SPACE) == GLFW_PRESS) { j1.apply_punch(); j2.apply_punch(); }
 
+        Tracer::Scope tracePhysics("physics");
         while (accumulator >= fixedDt) {
-            j1.Update((float)fixedDt, box);
-            j2.Update((float)fixedDt, box);
-            j1.CollideWith(j2);
+            world.step((float)fixedDt);
             accumulator -= fixedDt;
         }
+        tracePhysics.end();
+
+        if (dynamicResolution) gpuTimer.begin();
+        Tracer::Scope traceShadows("shadows");
+        gpuTrace.begin("shadows");
+
+        // Shadows: the floor and walls only when the light or the static scene changed, the
+        // jellies the light can see every frame
+        shadows.updateStatic([&] {
+            staticDepthShader.Activate();
+            staticScene.Draw(Brick);
+        });
+        const Frustum lightView = shadows.lightFrustum();
+        shadows.updateDynamic([&] {
+            (world.renderPath == RenderPath::ParticleBuffer ? jellyDepthShader : staticDepthShader).Activate();
+            world.render(&lightView);
+        });
+        shadows.Bind();
+        gpuTrace.end();
+        traceShadows.end();
+
+        // Point lights: jelly glows follow the bodies, fireflies drift on slow Lissajous paths
+        Tracer::Scope traceLights("lights");
+        lightList.clear();
+        for (size_t i = 0; i < world.bodyCount(); ++i) {
+            const Jelly& body = world.body(i);
+            const glm::vec3 center = 0.5f * (body.getMin() + body.getMax());
+            lightList.push_back({ center, 0.6f, glm::vec3(0.25f, 0.8f, 0.35f) });
+        }
+        for (int i = 0; i < fireflyCount; ++i) {
+            const float phase = 0.37f * i, speed = 0.2f + 0.002f * i;
+            const glm::vec3 p(0.9f * std::sin((float)t * speed + phase), 0.6f + 0.5f * std::sin((float)t * speed * 1.3f + 2.0f * phase),
+                0.9f * std::cos((float)t * speed * 0.7f + 3.0f * phase));
+            lightList.push_back({ p, 0.12f, glm::vec3(1.0f, 0.75f, 0.3f) * 0.4f });
+        }
+        pointLights.update(lightList, camera.viewMatrix, fov, (float)width / height, nearPlane, clusterFar);
+        pointLights.Bind();
+        traceLights.end();
+
+        // Opaque pass: floor, walls and the light cube
+        Tracer::Scope traceOpaque("opaque");
+        gpuTrace.begin("opaque");
+        if (dynamicResolution) oit.setRenderSize(resolution.size(width), resolution.size(height));
+        oit.beginOpaque();
+        glClearColor(0.07f, 0.13f, 0.17f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
         // Common per-frame uniforms
         shader.Activate();
         glUniform3f(glGetUniformLocation(shader.ID, "camPos"), camera.Position.x, camera.Position.y, camera.Position.z);
         camera.Matrix(shader, "camMatrix");
+        glUniformMatrix4fv(glGetUniformLocation(shader.ID, "view"), 1, GL_FALSE, glm::value_ptr(camera.viewMatrix));
+        pointLights.setUniforms(shader.ID, oit.renderWidth(), oit.renderHeight());
 
         // Draw floor & walls with BRICK texture
         brickTex.Bind();                 // unit 0; shader uses sampler "tex0"
         glUniformMatrix4fv(glGetUniformLocation(shader.ID, "model"), 1, GL_FALSE, glm::value_ptr(I));
-        floor.draw();
-        wallPosX.draw();
-        wallNegX.draw();
-        wallPosZ.draw();
-        wallNegZ.draw();
+        staticScene.Draw(Brick, &view);
         brickTex.Unbind();
 
-        // Draw jellies with SLIME texture (same sampler/unit)
-        jellyTex.Bind();
-        j1.Render();
-        j2.Render();
-        jellyTex.Unbind();
-
         // Draw light cube
         lightShader.Activate();
         camera.Matrix(lightShader, "camMatrix");
         lightVAO.Bind();
         glDrawElements(GL_TRIANGLES, (GLsizei)(sizeof(lightIdx) / sizeof(GLuint)), GL_UNSIGNED_INT, 0);
-
-        glfwSwapBuffers(window);
-        glfwPollEvents();
+        gpuTrace.end();
+        traceOpaque.end();
+
+        // Translucent pass: jellies with SLIME texture (same sampler/unit), any order
+        Tracer::Scope traceTranslucent("translucent");
+        gpuTrace.begin("translucent");
+        oit.beginTranslucent();
+        Shader& jellyLit = world.renderPath == RenderPath::ParticleBuffer ? jellyShader : jellyFaceShader;
+        jellyLit.Activate();
+        glUniform3f(glGetUniformLocation(jellyLit.ID, "camPos"), camera.Position.x, camera.Position.y, camera.Position.z);
+        camera.Matrix(jellyLit, "camMatrix");
+        glUniformMatrix4fv(glGetUniformLocation(jellyLit.ID, "view"), 1, GL_FALSE, glm::value_ptr(camera.viewMatrix));
+        pointLights.setUniforms(jellyLit.ID, oit.renderWidth(), oit.renderHeight());
+        jellyTex.Bind();
+        world.render(&view);
+        jellyTex.Unbind();
+        gpuTrace.end();
+        traceTranslucent.end();
+
+        Tracer::Scope traceResolve("resolve");
+        gpuTrace.begin("resolve");
+        oit.resolve(false);
+        if (showSprings) {
+            springOverlay.shader.Activate();
+            camera.Matrix(springOverlay.shader, "camMatrix");
+            world.renderSprings(springOverlay);
+        }
+        if (window) oit.present();
+        gpuTrace.end();
+        traceResolve.end();
+        if (dynamicResolution) {
+            gpuTimer.end();
+            double gpuMs = 0.0;
+            if (gpuTimer.poll(gpuMs)) resolution.update(gpuMs);
+        }
+        if (options.capture) options.capture->capture(oit.framebuffer());
+        gpuTrace.poll();
+
+        if (window) {
+            Tracer::Scope trace("swap");
+            if (options.pacer) {
+                if (options.pacer->finishBeforeSwap()) glFinish();
+                options.pacer->frameRendered();
+            }
+            glfwSwapBuffers(window);
+            if (options.pacer) {
+                options.pacer->framePresented();
+                if (t >= nextReport) {
+                    char title[128];
+                    std::snprintf(title, sizeof(title), "Jelly Cubes - %.0f fps, ~%.1f ms input-to-photon (%s)",
+                        1000.0 / options.pacer->frameMs(), options.pacer->latencyMs(), FramePacer::Name(options.pacer->mode));
+                    glfwSetWindowTitle(window, title);
+                    nextReport = t + 1.0;
+                }
+            }
+        }
     }
+    if (options.capture) options.capture->finish();
 
-    // Cleanup
-    lightVAO.Delete(); lightVBO.Delete(); lightEBO.Delete();
+    // Cleanup (buffers, VAOs, the static mesh and the world free themselves on the way out)
     brickTex.Delete(); jellyTex.Delete();
-    shader.Delete(); lightShader.Delete();
+    shader.Delete(); lightShader.Delete(); jellyShader.Delete(); jellyFaceShader.Delete();
+    staticDepthShader.Delete(); jellyDepthShader.Delete();
+}
+
+// Writes the run's telemetry (CSV, or JSON for a .json path) with a one-line summary on stderr.
+static void WriteTelemetry(const Telemetry& telemetry, const std::string& path) {
+    if (!telemetry.write(path)) { std::cerr << "could not write telemetry to " << path << "\n"; return; }
+    float worst = 0.0f;
+    for (const BodyStepStats& r : telemetry.all()) worst = std::max(worst, r.maxStrain);
+    const int blowup = telemetry.firstBlowup();
+    std::cerr << "telemetry: steps " << telemetry.firstStep() << ".." << telemetry.lastStep() << " to " << path
+        << ", worst strain " << worst;
+    if (blowup >= 0) std::cerr << ", first blowup at step " << blowup;
+    std::cerr << "\n";
+}
+
+// Offscreen rendering, e.g. for render farms or CI image/perf regression runs:
+//   --headless [--size WxH] [--frames N] [--out <prefix>] [--raw <file>|-] [--springs]
+//              [--telemetry <file.csv|file.json>] [--trace <file.json>]
+// --out writes <prefix>00000.ppm, ... ; --raw writes rgb24 frames back to back ("-": stdout).
+static int RunHeadless(int argc, char** argv) {
+    RunOptions options;
+    options.frames = 300;
+    std::string out, raw, telemetryPath, tracePath;
+    Telemetry telemetry;
+    for (int i = 0; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if (arg == "--size" && hasValue) std::sscanf(argv[++i], "%dx%d", &options.width, &options.height);
+        else if (arg == "--frames" && hasValue) options.frames = std::atoi(argv[++i]);
+        else if (arg == "--out" && hasValue) out = argv[++i];
+        else if (arg == "--raw" && hasValue) raw = argv[++i];
+        else if (arg == "--springs") options.springs = true;
+        else if (arg == "--telemetry" && hasValue) telemetryPath = argv[++i];
+        else if (arg == "--trace" && hasValue) tracePath = argv[++i];
+        else { std::cerr << "unknown headless option: " << arg << "\n"; return 1; }
+    }
+    if (options.width <= 0 || options.height <= 0 || options.frames <= 0) {
+        std::cerr << "headless needs a positive --size and --frames\n";
+        return 1;
+    }
+
+    HeadlessContext context;
+    if (!context.create()) { std::cerr << "Failed to create a headless GL context: " << context.error() << "\n"; return -1; }
+    glEnable(GL_DEPTH_TEST);
+
+    std::unique_ptr<FrameCapture> capture;
+    if (!raw.empty()) capture = std::make_unique<FrameCapture>(options.width, options.height, FrameCapture::Format::RawVideo, raw);
+    else if (!out.empty()) capture = std::make_unique<FrameCapture>(options.width, options.height, FrameCapture::Format::ImageSequence, out);
+    if (capture && !capture->ok()) return 1;
+    options.capture = capture.get();
+    if (!telemetryPath.empty()) options.telemetry = &telemetry;
+    StartTrace(tracePath);
+
+    // stdout may be the video, so the summary goes to stderr
+    const double start = (double)std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    RunScene(nullptr, options);
+    glFinish();
+    const double seconds = ((double)std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count() - start) * 1e-6;
+    std::cerr << options.frames << " frames at " << options.width << "x" << options.height << " in " << seconds << " s ("
+        << 1000.0 * seconds / options.frames << " ms/frame)";
+    if (capture) std::cerr << ", " << capture->framesWritten() << " written, " << capture->stalls() << " readback stalls";
+    if (capture && !capture->ok()) std::cerr << ", " << capture->failures() << " frames failed";
+    std::cerr << "\n";
+    const bool captured = !capture || capture->ok();
+    capture.reset();
+    if (options.telemetry) WriteTelemetry(telemetry, telemetryPath);
+    WriteTrace(tracePath);
+    return captured ? 0 : 1;
+}
+
+// Windowed: YoutubeOpenGL.exe [--pacing vsync|cap|lowlatency] [--fps N] [--telemetry <file>]
+//           [--trace <file.json>]
+// (--fps is the rate for cap, the display's refresh rate by default; vsync and lowlatency
+// follow the display; with --trace, T writes the timeline so far and it is written again at exit)
+int main(int argc, char** argv) {
+    // Headless benchmarks: YoutubeOpenGL.exe --bench [name ...]
+    if (argc > 1 && std::string(argv[1]) == "--bench") return RunBenchmarks(argc - 2, argv + 2);
+    if (argc > 1 && std::string(argv[1]) == "--headless") return RunHeadless(argc - 2, argv + 2);
+    PacingMode pacing = PacingMode::VSync;
+    double fps = 0.0;
+    std::string telemetryPath, tracePath;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--pacing" && i + 1 < argc && FramePacer::Parse(argv[i + 1], pacing)) ++i;
+        else if (arg == "--fps" && i + 1 < argc) fps = std::atof(argv[++i]);
+        else if (arg == "--telemetry" && i + 1 < argc) telemetryPath = argv[++i];
+        else if (arg == "--trace" && i + 1 < argc) tracePath = argv[++i];
+        else { std::cerr << "unknown option: " << arg << "\n"; return 1; }
+    }
+
+    // Init GLFW / context
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    RunOptions options;
+    GLFWwindow* window = glfwCreateWindow(options.width, options.height, "Jelly Cubes", NULL, NULL);
+    if (!window) { std::cout << "Failed to create GLFW window\n"; glfwTerminate(); return -1; }
+    glfwMakeContextCurrent(window);
+    gladLoadGL();
+
+    // Frame pacing, and the GPU budget of a frame at that rate (with some room for the CPU side)
+    const GLFWvidmode* mode = glfwGetVideoMode(glfwGetPrimaryMonitor());
+    const double refreshHz = mode && mode->refreshRate > 0 ? mode->refreshRate : 60.0;
+    FramePacer pacer(pacing, pacing == PacingMode::Capped && fps > 0.0 ? fps : refreshHz, refreshHz);
+    glfwSwapInterval(pacer.swapInterval());
+    options.pacer = &pacer;
+    options.targetGpuMs = 0.9 * 1000.0 / pacer.hz;
+    Telemetry telemetry;
+    if (!telemetryPath.empty()) options.telemetry = &telemetry;
+    options.tracePath = tracePath;
+    StartTrace(tracePath);
+    glViewport(0, 0, options.width, options.height);
+    glEnable(GL_DEPTH_TEST);
+
+    // every GL object of the scene is gone when this returns, before the context is
+    RunScene(window, options);
+    if (options.telemetry) WriteTelemetry(telemetry, telemetryPath);
+    WriteTrace(tracePath);
+
     glfwDestroyWindow(window);
     glfwTerminate();
     return 0;
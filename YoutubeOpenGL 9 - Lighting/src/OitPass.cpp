@@ -0,0 +1,134 @@
+#include "OitPass.h"
+#include <iostream>
+
+namespace {
+
+GLuint makeTarget(GLenum internalFormat, GLenum format, int width, int height)
+{
+    GLuint tex = 0;
+    glGenTextures(1, &tex);
+    glBindTexture(GL_TEXTURE_2D, tex);
+    glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, format, GL_FLOAT, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    return tex;
+}
+
+void checkComplete(const char* name)
+{
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        std::cerr << "OitPass: " << name << " framebuffer incomplete" << std::endl;
+}
+
+} // namespace
+
+OitPass::OitPass(int width_, int height_)
+    : width(width_), height(height_), renderW(width_), renderH(height_), resolveShader("oit_resolve.vert", "oit_resolve.frag")
+{
+    // opaque target: color plus the depth buffer both passes test against
+    sceneColor = makeTarget(GL_RGBA8, GL_RGBA, width, height);
+    glGenRenderbuffers(1, &depth);
+    glBindRenderbuffer(GL_RENDERBUFFER, depth);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glGenFramebuffers(1, &sceneFbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, sceneFbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, sceneColor, 0);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depth);
+    checkComplete("opaque");
+
+    // accumulation targets, sharing the opaque depth
+    accumTex = makeTarget(GL_RGBA16F, GL_RGBA, width, height);
+    weightTex = makeTarget(GL_R16F, GL_RED, width, height);
+    glGenFramebuffers(1, &oitFbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, oitFbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, accumTex, 0);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, weightTex, 0);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depth);
+    const GLenum buffers[] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+    glDrawBuffers(2, buffers);
+    checkComplete("accumulation");
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    resolveShader.Activate();
+    glUniform1i(glGetUniformLocation(resolveShader.ID, "accumTex"), 0);
+    glUniform1i(glGetUniformLocation(resolveShader.ID, "weightTex"), 1);
+}
+
+OitPass::~OitPass()
+{
+    const GLuint fbos[] = { sceneFbo, oitFbo };
+    glDeleteFramebuffers(2, fbos);
+    const GLuint textures[] = { sceneColor, accumTex, weightTex };
+    glDeleteTextures(3, textures);
+    glDeleteRenderbuffers(1, &depth);
+    resolveShader.Delete();
+}
+
+void OitPass::setRenderSize(int renderWidth, int renderHeight)
+{
+    renderW = renderWidth < 1 ? 1 : (renderWidth > width ? width : renderWidth);
+    renderH = renderHeight < 1 ? 1 : (renderHeight > height ? height : renderHeight);
+}
+
+void OitPass::beginOpaque()
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, sceneFbo);
+    glViewport(0, 0, renderW, renderH);
+    // so clears touch only the part in use too
+    glEnable(GL_SCISSOR_TEST);
+    glScissor(0, 0, renderW, renderH);
+}
+
+void OitPass::beginTranslucent()
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, oitFbo);
+    const GLfloat accumClear[] = { 0.0f, 0.0f, 0.0f, 1.0f };   // nothing yet, fully revealed
+    const GLfloat weightClear[] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    glClearBufferfv(GL_COLOR, 0, accumClear);
+    glClearBufferfv(GL_COLOR, 1, weightClear);
+
+    glDepthMask(GL_FALSE);
+    glEnable(GL_BLEND);
+    // rgb: dst + src; alpha: dst * (1 - src alpha)
+    glBlendFuncSeparate(GL_ONE, GL_ONE, GL_ZERO, GL_ONE_MINUS_SRC_ALPHA);
+}
+
+void OitPass::resolve(bool toWindow)
+{
+    // average translucent color over the opaque image, by how much of it is covered
+    glBindFramebuffer(GL_FRAMEBUFFER, sceneFbo);
+    glDisable(GL_DEPTH_TEST);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    resolveShader.Activate();
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, accumTex);
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, weightTex);
+    fullscreen.Bind();
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    fullscreen.Unbind();
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    glDisable(GL_BLEND);
+    glDepthMask(GL_TRUE);
+    glEnable(GL_DEPTH_TEST);
+    glDisable(GL_SCISSOR_TEST);
+    if (toWindow) present();
+}
+
+void OitPass::present()
+{
+    // bilinear upscale when rendering below the window size
+    const bool scaled = renderW != width || renderH != height;
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, sceneFbo);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+    glBlitFramebuffer(0, 0, renderW, renderH, 0, 0, width, height, GL_COLOR_BUFFER_BIT, scaled ? GL_LINEAR : GL_NEAREST);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include <glad/glad.h>
+#include "shaderClass.h"
+#include "VAO.h"
+
+// Weighted blended order-independent transparency (McGuire & Bavoil 2013), on GL 3.3 core.
+// The opaque scene renders into an offscreen target; translucent surfaces then go, in any
+// order and with no sorting, into an accumulation target that shares its depth buffer; the
+// resolve composites them over the opaque image and copies the result to the window.
+//
+// GL 3.3 has one blend function for all draw buffers (glBlendFunci is 4.0), so the usual
+// accumulation/revealage pair is laid out to blend the same way: RGB adds, alpha multiplies.
+//   target 0 (RGBA16F): rgb = sum of color * alpha * weight, a = product of (1 - alpha)
+//   target 1 (R16F):    r = sum of alpha * weight
+// default.frag writes both when its "opacity" uniform is below 1.
+//
+// The targets are allocated at the window size, but a frame may render into just the
+// lower-left renderWidth x renderHeight of them (dynamic resolution); resolve then scales
+// that up to the window with bilinear filtering.
+class OitPass {
+public:
+    OitPass(int width, int height);
+    ~OitPass();
+    OitPass(const OitPass&) = delete;
+    OitPass& operator=(const OitPass&) = delete;
+
+    // the internal resolution from the next beginOpaque on, clamped to the window size
+    void setRenderSize(int renderWidth, int renderHeight);
+    int renderWidth() const { return renderW; }
+    int renderHeight() const { return renderH; }
+
+    void beginOpaque();        // binds the opaque target and sets the viewport; clear and draw as usual
+    void beginTranslucent();   // binds the accumulation targets; depth test on, no depth writes
+    // composites onto the opaque image, and copies that to the window (scaled up to its
+    // size) unless headless. Overlays can draw into framebuffer() between resolve(false)
+    // and present(), depth tested against the opaque scene.
+    void resolve(bool toWindow = true);
+    void present();
+    GLuint framebuffer() const { return sceneFbo; }   // the finished frame, after resolve
+
+private:
+    int width, height;
+    int renderW, renderH;
+    GLuint sceneFbo = 0, sceneColor = 0, depth = 0;
+    GLuint oitFbo = 0, accumTex = 0, weightTex = 0;
+    Shader resolveShader;
+    VAO fullscreen;            // no attributes: the resolve triangle comes from gl_VertexID
+};
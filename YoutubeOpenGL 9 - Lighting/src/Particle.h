@@ -0,0 +1,10 @@
+#pragma once
+#include <glm/glm.hpp>
+
+// One point of a soft body. Verlet: the velocity is implicit in p - prev.
+struct Particle {
+    glm::vec3 p;       // current
+    glm::vec3 prev;    // previous (for Verlet)
+    glm::vec3 a;       // accumulated accel (gravity etc.)
+    float invMass;     // 1/mass
+};
@@ -0,0 +1,273 @@
+#include "PhysicsWorld.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <numeric>
+#include "Tracer.h"
+
+PhysicsWorld::PhysicsWorld(ColliderSet colliders_, JobSystem& jobs_)
+    : colliders(std::move(colliders_)), jobs(jobs_)
+{
+}
+
+Jelly& PhysicsWorld::add(std::unique_ptr<Jelly> body)
+{
+    if (body->renderPath != renderPath) {
+        body->renderPath = renderPath;
+        body->BuildRenderVertices();
+    }
+    body->jobs = &jobs;   // a big Jacobi body splits its passes over the world's threads
+    bodies.push_back(std::move(body));
+    renderStale.push_back(1);
+    rayBoundsStale = true;
+    return *bodies.back();
+}
+
+void PhysicsWorld::remove(const Jelly& body)
+{
+    auto it = std::find_if(bodies.begin(), bodies.end(), [&](const std::unique_ptr<Jelly>& b) { return b.get() == &body; });
+    if (it == bodies.end()) return;
+    if (grabbed == &body) release();
+    renderStale.erase(renderStale.begin() + (it - bodies.begin()));
+    bodies.erase(it);
+    rayBoundsStale = true;
+}
+
+int PhysicsWorld::findRoot(int i)
+{
+    while (parent[i] != i) {
+        parent[i] = parent[parent[i]]; // path halving
+        i = parent[i];
+    }
+    return i;
+}
+
+void PhysicsWorld::buildIslands()
+{
+    const int n = (int)bodies.size();
+    boundsMin.resize(n);
+    boundsMax.resize(n);
+    for (int i = 0; i < n; ++i) {
+        bodies[i]->predictedBounds(boundsMin[i], boundsMax[i]);
+        boundsMin[i] -= contactMargin;
+        boundsMax[i] += contactMargin;
+    }
+
+    // sweep and prune along x; ties broken by index so the pair list never depends on sort
+    // stability
+    sweepOrder.resize(n);
+    std::iota(sweepOrder.begin(), sweepOrder.end(), 0);
+    std::sort(sweepOrder.begin(), sweepOrder.end(), [&](int a, int b) {
+        return boundsMin[a].x < boundsMin[b].x || (boundsMin[a].x == boundsMin[b].x && a < b);
+        });
+
+    parent.resize(n);
+    std::iota(parent.begin(), parent.end(), 0);
+    pairs.clear();
+    for (int a = 0; a < n; ++a) {
+        const int i = sweepOrder[a];
+        for (int b = a + 1; b < n && boundsMin[sweepOrder[b]].x <= boundsMax[i].x; ++b) {
+            const int j = sweepOrder[b];
+            if (boundsMin[i].y > boundsMax[j].y || boundsMin[j].y > boundsMax[i].y ||
+                boundsMin[i].z > boundsMax[j].z || boundsMin[j].z > boundsMax[i].z) continue;
+            pairs.push_back({ std::min(i, j), std::max(i, j) });
+            const int ri = findRoot(i), rj = findRoot(j);
+            if (ri != rj) parent[std::max(ri, rj)] = std::min(ri, rj); // the root is the lowest index
+        }
+    }
+
+    // islands numbered by their lowest body, bodies ascending within each (counting sort)
+    std::vector<int>& islandOf = sweepOrder; // reused: body -> island
+    std::vector<int> rootIsland(n, -1);
+    int islands = 0;
+    for (int i = 0; i < n; ++i) {
+        const int r = findRoot(i);
+        if (rootIsland[r] < 0) rootIsland[r] = islands++;
+        islandOf[i] = rootIsland[r];
+    }
+    islandStart.assign(islands + 1, 0);
+    for (int i = 0; i < n; ++i) ++islandStart[islandOf[i] + 1];
+    for (int k = 0; k < islands; ++k) islandStart[k + 1] += islandStart[k];
+    islandBodies.resize(n);
+    std::vector<int> fill(islandStart.begin(), islandStart.end() - 1);
+    for (int i = 0; i < n; ++i) islandBodies[fill[islandOf[i]]++] = i;
+
+    std::sort(pairs.begin(), pairs.end());
+    pairStart.assign(islands + 1, 0);
+    for (const auto& pr : pairs) ++pairStart[islandOf[pr.first] + 1];
+    for (int k = 0; k < islands; ++k) pairStart[k + 1] += pairStart[k];
+    islandPairs.resize(pairs.size());
+    fill.assign(pairStart.begin(), pairStart.end() - 1);
+    for (const auto& pr : pairs) islandPairs[fill[islandOf[pr.first]]++] = pr;
+
+    // queue the biggest islands first so one late big island does not leave the other
+    // threads idle at the end
+    std::vector<int> cost(islands, 0);
+    for (int i = 0; i < n; ++i) cost[islandOf[i]] += bodies[i]->springCount();
+    dispatchOrder.resize(islands);
+    std::iota(dispatchOrder.begin(), dispatchOrder.end(), 0);
+    std::stable_sort(dispatchOrder.begin(), dispatchOrder.end(), [&](int a, int b) { return cost[a] > cost[b]; });
+}
+
+void PhysicsWorld::stepIsland(int k, float dt)
+{
+    using Clock = std::chrono::steady_clock;
+    Tracer::Scope trace("island", k);
+    const bool measuring = telemetry != nullptr;
+    for (int b = islandStart[k]; b < islandStart[k + 1]; ++b) {
+        Jelly& body = *bodies[islandBodies[b]];
+        Tracer::Scope traceBody("Jelly::Step", islandBodies[b]);
+        body.recordResidual = measuring;
+        if (!measuring) { body.Step(dt, colliders); continue; }
+        const Clock::time_point start = Clock::now();
+        body.Step(dt, colliders);
+        stepStats[islandBodies[b]].stepUs = std::chrono::duration<float, std::micro>(Clock::now() - start).count();
+    }
+    Tracer::Scope traceContacts("contacts", k);
+    for (int p = pairStart[k]; p < pairStart[k + 1]; ++p) {
+        const std::pair<int, int>& pr = islandPairs[p];
+        if (bodies[pr.first]->CollideWith(*bodies[pr.second]) && measuring) {
+            ++stepStats[pr.first].bodyContacts;
+            ++stepStats[pr.second].bodyContacts;
+        }
+    }
+    if (measuring)
+        for (int b = islandStart[k]; b < islandStart[k + 1]; ++b)
+            bodies[islandBodies[b]]->measure(dt, colliders, stepStats[islandBodies[b]]);
+}
+
+void PhysicsWorld::step(float dt)
+{
+    Tracer::Scope trace("PhysicsWorld::step");
+    {
+        Tracer::Scope traceIslands("islands");
+        buildIslands();
+    }
+    if (telemetry) {
+        // one slot per body, so the island jobs fill them without sharing any
+        stepStats.assign(bodies.size(), BodyStepStats());
+        for (size_t i = 0; i < stepStats.size(); ++i) {
+            stepStats[i].step = steps;
+            stepStats[i].body = (int)i;
+        }
+    }
+    jobs.parallelFor(islandCount(), 1, [&](int begin, int end) {
+        for (int k = begin; k < end; ++k) stepIsland(dispatchOrder[k], dt);
+        });
+    if (telemetry) telemetry->append(stepStats);
+    ++steps;
+    std::fill(renderStale.begin(), renderStale.end(), (uint8_t)1);
+    rayBoundsStale = true;
+}
+
+void PhysicsWorld::renderSprings(SpringOverlay& overlay)
+{
+    if (!pool || pool->path != RenderPath::ParticleBuffer) return;
+    pool->Bind();   // for the position texture; the overlay draws with its own VAO
+    overlay.begin();
+    for (int i : drawList) bodies[i]->RenderSprings(overlay);
+    overlay.end();
+}
+
+bool PhysicsWorld::raycast(const Ray& ray, float maxT, RayHit& hit)
+{
+    const int n = (int)bodies.size();
+    if (rayBoundsStale) {
+        rayBounds.clear();
+        for (const auto& b : bodies) rayBounds.push(b->getMin(), b->getMax());
+        rayBoundsStale = false;
+    }
+    rayBoxes(ray, rayBounds, maxT, rayEnter);
+    rayOrder.clear();
+    for (int i = 0; i < n; ++i)
+        if (rayEnter[i] <= maxT) rayOrder.push_back(i);
+    std::sort(rayOrder.begin(), rayOrder.end(), [&](int a, int b) {
+        return rayEnter[a] < rayEnter[b] || (rayEnter[a] == rayEnter[b] && a < b);
+        });
+
+    bool found = false;
+    for (int i : rayOrder) {
+        if (rayEnter[i] >= maxT) break;   // this box and every later one start beyond the best hit
+        if (bodies[i]->raycast(ray, maxT, hit)) {
+            hit.body = i;
+            maxT = hit.t;
+            found = true;
+        }
+    }
+    return found;
+}
+
+void PhysicsWorld::grab(const RayHit& hit)
+{
+    if (hit.body < 0 || hit.body >= (int)bodies.size()) return;
+    release();
+    grabbed = bodies[hit.body].get();
+    grabParticle = hit.particle;
+    grabDistance = hit.t;
+    grabbed->setDrag(grabParticle, hit.point);
+}
+
+void PhysicsWorld::drag(const Ray& ray)
+{
+    if (grabbed) grabbed->setDrag(grabParticle, ray.at(grabDistance));
+}
+
+void PhysicsWorld::release()
+{
+    if (grabbed) grabbed->clearDrag();
+    grabbed = nullptr;
+    grabParticle = -1;
+}
+
+void PhysicsWorld::render(const Frustum* frustum)
+{
+    if (!pool) pool = std::make_unique<JellyMeshPool>(renderPath);
+
+    // the bodies' AABBs are current after every step, so culling costs one box test each
+    const int n = (int)bodies.size();
+    if (frustum) {
+        bounds.clear();
+        for (const auto& b : bodies) bounds.push(b->getMin(), b->getMax());
+        frustum->cull(bounds, visible);
+    }
+    else {
+        visible.assign(n, 1);
+    }
+    drawList.clear();
+    for (int i = 0; i < n; ++i)
+        if (visible[i]) drawList.push_back(i);
+
+    jobs.parallelFor((int)drawList.size(), 1, [&](int begin, int end) {
+        Tracer::Scope trace("build vertices");
+        for (int k = begin; k < end; ++k)
+            if (renderStale[drawList[k]]) bodies[drawList[k]]->BuildRenderVertices();
+        });
+    {
+        // bodies added since the last render take their ranges here, before the pool is bound
+        Tracer::Scope trace("upload");
+        bool full = false;
+        for (int i : drawList) {
+            if (renderStale[i] || !bodies[i]->IsUploaded()) bodies[i]->UploadRenderVertices(*pool);
+            renderStale[i] = 0;
+            full = full || !bodies[i]->IsUploaded();
+        }
+        if (full && renderPath == RenderPath::ParticleBuffer) {
+            // more particles than the position texture can address: every body moves to face
+            // vertices for good. The caller's shaders are for the old path, so this call draws
+            // nothing; the next one uploads everything again.
+            std::cerr << "PhysicsWorld: position texture full, falling back to face vertices" << std::endl;
+            renderPath = RenderPath::FaceVertices;
+            for (size_t i = 0; i < bodies.size(); ++i) {
+                bodies[i]->ReleaseRenderVertices(renderPath);
+                renderStale[i] = 1;
+            }
+            pool = std::make_unique<JellyMeshPool>(renderPath);
+            return;
+        }
+    }
+
+    Tracer::Scope trace("draw");
+    pool->Bind();
+    for (int i : drawList) bodies[i]->Render(*pool);
+    pool->Unbind();
+}
@@ -0,0 +1,114 @@
+#pragma once
+#include <memory>
+#include <utility>
+#include <vector>
+#include <glm/glm.hpp>
+#include "Jelly.h"
+#include "Frustum.h"
+#include "JellyMeshPool.h"
+#include "Collider.h"
+#include "JobSystem.h"
+#include "Raycast.h"
+#include "SpringOverlay.h"
+#include "Telemetry.h"
+
+// Owns every jelly plus the static colliders and steps them together.
+//
+// Each step the bodies are grouped into islands: connected components of bodies whose
+// predicted bounds overlap (a body on its own is an island too). Islands share no bodies,
+// so they step in parallel as jobs. Within an island the bodies are stepped and their
+// pair contacts resolved in a fixed order, so the result is the same for any thread count
+// or schedule.
+//
+// All bodies draw from one JellyMeshPool, created by the first render(), so the world must
+// be destroyed while the GL context is still current once it has rendered. Bodies outside
+// the view frustum are not rebuilt, uploaded or drawn; they catch up when they come back.
+class PhysicsWorld {
+public:
+    explicit PhysicsWorld(ColliderSet colliders = ColliderSet(), JobSystem& jobs = JobSystem::Shared());
+
+    // takes ownership; the reference stays valid until the body is removed. The body is
+    // switched to the world's renderPath and steps on the world's JobSystem.
+    Jelly& add(std::unique_ptr<Jelly> body);
+    void remove(const Jelly& body);   // destroys it; the rest keep their order
+
+    void step(float dt);     // physics only, no GL calls
+    // refresh render vertices (in parallel) of visible bodies stepped since they were last
+    // drawn, upload and draw them (GL thread); no frustum draws everything
+    void render(const Frustum* frustum = nullptr);
+    // the spring networks of the bodies the last render drew, read from what it uploaded
+    // (ParticleBuffer only); the overlay's shader must be active
+    void renderSprings(SpringOverlay& overlay);
+    int visibleCount() const { return (int)drawList.size(); }  // as of the last render
+    JellyMeshPool* meshPool() { return pool.get(); }  // null until the first render
+
+    size_t bodyCount() const { return bodies.size(); }
+    Jelly& body(size_t i) { return *bodies[i]; }
+    int islandCount() const { return (int)islandStart.size() - 1; }  // as of the last step
+    int stepCount() const { return steps; }
+    int threadCount() const { return jobs.threadCount(); }
+
+    // Nearest body surface the ray hits closer than maxT, between steps. The ray goes through
+    // the bodies' AABBs in one batched pass first; the boxes it enters are then searched
+    // nearest first (Jelly::raycast), stopping at the first box that starts beyond the best
+    // hit, so past that one pass a query only touches the triangles of a body or two.
+    bool raycast(const Ray& ray, float maxT, RayHit& hit);
+
+    // Mouse drag: grab pins the hit particle to the point at the hit's distance along the
+    // ray, drag moves that point along with a new ray, release lets go (removing the body
+    // does too). The pin is part of every solver pass, so the body follows it softly.
+    void grab(const RayHit& hit);
+    void drag(const Ray& ray);
+    void release();
+    bool dragging() const { return grabbed != nullptr; }
+
+    ColliderSet colliders;
+    float contactMargin = 0.02f;  // predicted bounds are padded this much before pairing
+    // for every body; fixed by the first render, except that a render that finds the position
+    // texture full switches it to FaceVertices once (and draws nothing), so pick the shaders
+    // from it before each render
+    RenderPath renderPath = RenderPath::ParticleBuffer;
+    // while set, every step appends one BodyStepStats per body (measured by the island jobs,
+    // after the island's contacts); null costs one branch per body
+    Telemetry* telemetry = nullptr;
+
+private:
+    void buildIslands();
+    void stepIsland(int island, float dt);
+    int findRoot(int i);
+
+    std::unique_ptr<JellyMeshPool> pool;       // declared before the bodies, which hold ranges of it
+    std::vector<std::unique_ptr<Jelly>> bodies;
+    JobSystem& jobs;
+    std::vector<uint8_t> renderStale;          // per body: stepped since its last upload
+    int steps = 0;
+    std::vector<BodyStepStats> stepStats;      // telemetry: this step's, per body
+
+    // ray query scratch: the bodies' AABBs, rebuilt after a step, and the entry distances
+    BoxList rayBounds;
+    bool rayBoundsStale = true;
+    std::vector<float> rayEnter;
+    std::vector<int> rayOrder;
+
+    Jelly* grabbed = nullptr;
+    int grabParticle = -1;
+    float grabDistance = 0.0f;
+
+    // render scratch
+    BoxList bounds;
+    std::vector<uint32_t> visible;
+    std::vector<int> drawList;
+
+    // broad phase scratch
+    std::vector<glm::vec3> boundsMin, boundsMax;
+    std::vector<int> sweepOrder;
+    std::vector<int> parent;                   // union-find over bodies
+    std::vector<std::pair<int, int>> pairs;    // overlapping (i < j)
+
+    // island k: bodies islandBodies[islandStart[k] .. islandStart[k+1]), both ascending,
+    // and its pairs islandPairs[pairStart[k] .. pairStart[k+1]), sorted
+    std::vector<int> islandStart{ 0 }, islandBodies;
+    std::vector<int> pairStart{ 0 };
+    std::vector<std::pair<int, int>> islandPairs;
+    std::vector<int> dispatchOrder;            // islands, largest first
+};
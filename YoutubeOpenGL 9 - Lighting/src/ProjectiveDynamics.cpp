@@ -0,0 +1,135 @@
+// Only the Projective Dynamics benchmark uses this (see SolverBackend in Jelly.h)
+#ifdef JELLY_BENCH_PD
+#include "ProjectiveDynamics.h"
+#include <algorithm>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <tuple>
+
+PDSystem::PDSystem(const std::shared_ptr<const JellyTopology>& topo_, float pointMass_, float dt_, float stiffness_)
+    : topo(topo_), pointMass(pointMass_), dt(dt_), stiffness(stiffness_)
+{
+    const int n = topo->particleCount();
+    const int count = topo->springCount();
+    massOverH2 = pointMass / (dt * dt);
+
+    std::vector<EnvelopeCholesky::Entry> lower;
+    lower.reserve(n + 2 * (size_t)count);
+    for (int i = 0; i < n; ++i) lower.push_back({ i, i, massOverH2 });
+
+    weights.resize(count);
+    for (int s = 0; s < count; ++s) {
+        const float w = topo->springK[s] * stiffness;
+        const int i = topo->springI(s), j = topo->springJ(s);
+        weights[s] = w;
+        lower.push_back({ i, i, w });
+        lower.push_back({ j, j, w });
+        lower.push_back({ std::max(i, j), std::min(i, j), -w });
+    }
+
+    if (!factor.factor(n, lower))
+        std::cout << "PDSystem: system matrix is not positive definite" << std::endl;
+}
+
+std::shared_ptr<const PDSystem> PDSystem::Get(const std::shared_ptr<const JellyTopology>& topo,
+    float pointMass, float dt, float stiffness)
+{
+    using Key = std::tuple<const JellyTopology*, float, float, float>;
+    static std::mutex mtx;
+    static std::map<Key, std::weak_ptr<const PDSystem>> cache;
+
+    const Key key(topo.get(), pointMass, dt, stiffness);
+
+    std::lock_guard<std::mutex> lock(mtx);
+    auto& slot = cache[key];
+    // a live system keeps its topology alive, so a hit can't be a recycled address
+    if (auto sys = slot.lock()) return sys;
+
+    std::shared_ptr<const PDSystem> sys(new PDSystem(topo, pointMass, dt, stiffness));
+    slot = sys;
+    return sys;
+}
+
+// Component-wise a / b, with 0 where b is 0.
+static glm::vec3 safeDiv(const glm::vec3& a, const glm::vec3& b)
+{
+    return glm::vec3(b.x != 0.0f ? a.x / b.x : 0.0f, b.y != 0.0f ? a.y / b.y : 0.0f, b.z != 0.0f ? a.z / b.z : 0.0f);
+}
+
+void PDSystem::multiply(const glm::vec3* x, glm::vec3* out) const
+{
+    const int n = topo->particleCount();
+    const int count = topo->springCount();
+    for (int i = 0; i < n; ++i) out[i] = massOverH2 * x[i];
+    for (int s = 0; s < count; ++s) {
+        const int i = topo->springI(s), j = topo->springJ(s);
+        const glm::vec3 f = weights[s] * (x[j] - x[i]);
+        out[i] -= f;
+        out[j] += f;
+    }
+}
+
+void PDSystem::solveWithContacts(const std::vector<glm::vec3>& rhs, std::vector<glm::vec3>& x,
+    const std::vector<Contact>& contacts, int maxIterations, float tolerance, ContactWork& work) const
+{
+    const size_t n = rhs.size();
+    const size_t nc = contacts.size();
+    if (nc == 0 || maxIterations <= 0) {
+        // nothing on the diagonal but the factored matrix: one plain solve, no CG
+        x = rhs;
+        factor.solve(x.data());
+        return;
+    }
+
+    // r = b - (A + D) x for the warm start
+    work.r.resize(n);
+    work.z.resize(n);
+    work.p.resize(n);
+    work.q.resize(n);
+    multiply(x.data(), work.q.data());
+    for (size_t i = 0; i < n; ++i) work.r[i] = rhs[i] - work.q[i];
+    for (const Contact& c : contacts) work.r[c.index] -= c.weight * x[c.index];
+
+    // x, y and z are three independent solves; each stops on its own
+    const float tol2 = tolerance * tolerance * (float)n;
+    glm::vec3 rz(0.0f);
+    glm::bvec3 active(true);
+    for (int it = 0; it < maxIterations; ++it) {
+        work.z = work.r;
+        factor.solve(work.z.data());
+
+        glm::vec3 rzNew(0.0f), zz(0.0f);
+        for (size_t i = 0; i < n; ++i) {
+            rzNew += work.r[i] * work.z[i];
+            zz += work.z[i] * work.z[i];
+        }
+        // always take the first step: without contacts it would be the exact answer
+        if (it > 0)
+            for (int c = 0; c < 3; ++c)
+                active[c] = active[c] && zz[c] > tol2;
+        if (!glm::any(active)) break;
+        const glm::vec3 mask(active);
+
+        if (it == 0) work.p = work.z;
+        else {
+            const glm::vec3 beta = safeDiv(rzNew, rz) * mask;
+            for (size_t i = 0; i < n; ++i) work.p[i] = work.z[i] + beta * work.p[i];
+        }
+        rz = rzNew;
+
+        // q = (A + D) p
+        multiply(work.p.data(), work.q.data());
+        for (const Contact& c : contacts) work.q[c.index] += c.weight * work.p[c.index];
+        glm::vec3 pq(0.0f);
+        for (size_t i = 0; i < n; ++i) pq += work.p[i] * work.q[i];
+
+        const glm::vec3 alpha = safeDiv(rz, pq) * mask;
+        for (size_t i = 0; i < n; ++i) {
+            x[i] += alpha * work.p[i];
+            work.r[i] -= alpha * work.q[i];
+        }
+    }
+}
+
+#endif // JELLY_BENCH_PD
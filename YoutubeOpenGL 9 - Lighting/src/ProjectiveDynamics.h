@@ -0,0 +1,48 @@
+#pragma once
+#include <memory>
+#include <vector>
+#include <glm/glm.hpp>
+#include "JellyTopology.h"
+#include "EnvelopeCholesky.h"
+
+// The constant global system of Projective Dynamics (Bouaziz et al. 2014) for one jelly
+// topology:  (M / h^2 + sum_s w_s A_s^T A_s) x = M / h^2 y + sum_s w_s A_s^T p_s
+// where A_s x = x_j - x_i for spring s and p_s is its projected (rest length) edge.
+// The matrix only depends on topology, mass, timestep and stiffness, so it is factored
+// once and shared by every jelly that steps with the same parameters.
+class PDSystem {
+public:
+    static std::shared_ptr<const PDSystem> Get(const std::shared_ptr<const JellyTopology>& topo,
+        float pointMass, float dt, float stiffness);
+
+    // A particle held against a collider: the penalty weight per axis (zero on the
+    // axes it is free to slide along).
+    struct Contact { int index; glm::vec3 weight; };
+    // Scratch space for solveWithContacts, owned by the caller so the system can stay shared.
+    struct ContactWork { std::vector<glm::vec3> r, z, p, q; };
+
+    // rhs in, positions out
+    void solve(std::vector<glm::vec3>& rhs) const { factor.solve(rhs.data()); }
+
+    // out = A x, straight from the springs (no factor involved)
+    void multiply(const glm::vec3* x, glm::vec3* out) const;
+
+    // Same as solve, with the contact penalties added to the diagonal (rhs must already hold
+    // the weight * target terms). The contact set changes every iteration, so instead of
+    // refactoring this runs conjugate gradients preconditioned with the factor of the
+    // contact-free matrix, warm-started from x (the previous iterate). Every CG step costs
+    // one factor solve; it stops once the preconditioned residual, which is about the
+    // position error, is below `tolerance` (meters RMS) or after maxIterations steps. A
+    // warm start that is already close costs one solve, the same as no contacts at all.
+    void solveWithContacts(const std::vector<glm::vec3>& rhs, std::vector<glm::vec3>& x,
+        const std::vector<Contact>& contacts, int maxIterations, float tolerance, ContactWork& work) const;
+
+    std::shared_ptr<const JellyTopology> topo;
+    float pointMass, dt, stiffness;
+    float massOverH2;            // m / h^2, the inertia term on the diagonal
+    std::vector<float> weights;  // w_s = springK[s] * stiffness
+    EnvelopeCholesky factor;
+
+private:
+    PDSystem(const std::shared_ptr<const JellyTopology>& topo, float pointMass, float dt, float stiffness);
+};
@@ -0,0 +1,81 @@
+#include "Raycast.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+float safeInverse(float d)
+{
+    // an axis-parallel ray still gets finite slab distances (inf * 0 would be NaN)
+    return 1.0f / (std::fabs(d) > 1e-20f ? d : (d < 0.0f ? -1e-20f : 1e-20f));
+}
+
+} // namespace
+
+Ray::Ray(const glm::vec3& origin_, const glm::vec3& dir_)
+    : origin(origin_), dir(dir_), invDir(safeInverse(dir_.x), safeInverse(dir_.y), safeInverse(dir_.z))
+{
+}
+
+Ray Ray::FromScreen(const glm::mat4& viewProjection, double x, double y, int width, int height)
+{
+    const float ndcX = (float)(2.0 * x / width - 1.0);
+    const float ndcY = (float)(1.0 - 2.0 * y / height);
+    const glm::mat4 inv = glm::inverse(viewProjection);
+    const glm::vec4 nearPoint = inv * glm::vec4(ndcX, ndcY, -1.0f, 1.0f);
+    const glm::vec4 farPoint = inv * glm::vec4(ndcX, ndcY, 1.0f, 1.0f);
+    const glm::vec3 origin = glm::vec3(nearPoint) / nearPoint.w;
+    return Ray(origin, glm::normalize(glm::vec3(farPoint) / farPoint.w - origin));
+}
+
+bool rayBox(const Ray& ray, const glm::vec3& mn, const glm::vec3& mx, float maxT, float& enter)
+{
+    const glm::vec3 t1 = (mn - ray.origin) * ray.invDir;
+    const glm::vec3 t2 = (mx - ray.origin) * ray.invDir;
+    const glm::vec3 lo = glm::min(t1, t2), hi = glm::max(t1, t2);
+    const float tEnter = std::max(std::max(lo.x, lo.y), std::max(lo.z, 0.0f));
+    const float tExit = std::min(std::min(hi.x, hi.y), std::min(hi.z, maxT));
+    enter = tEnter;
+    return tEnter <= tExit;
+}
+
+void rayBoxes(const Ray& ray, const BoxList& boxes, float maxT, std::vector<float>& enter)
+{
+    const size_t n = boxes.size();
+    enter.resize(n);
+    const float* minX = boxes.minX.data(); const float* maxX = boxes.maxX.data();
+    const float* minY = boxes.minY.data(); const float* maxY = boxes.maxY.data();
+    const float* minZ = boxes.minZ.data(); const float* maxZ = boxes.maxZ.data();
+    float* out = enter.data();
+    const float ox = ray.origin.x, oy = ray.origin.y, oz = ray.origin.z;
+    const float ix = ray.invDir.x, iy = ray.invDir.y, iz = ray.invDir.z;
+    const float miss = std::numeric_limits<float>::infinity();
+
+    for (size_t i = 0; i < n; ++i) {
+        const float x1 = (minX[i] - ox) * ix, x2 = (maxX[i] - ox) * ix;
+        const float y1 = (minY[i] - oy) * iy, y2 = (maxY[i] - oy) * iy;
+        const float z1 = (minZ[i] - oz) * iz, z2 = (maxZ[i] - oz) * iz;
+        const float tEnter = std::max(std::max(std::min(x1, x2), std::min(y1, y2)), std::max(std::min(z1, z2), 0.0f));
+        const float tExit = std::min(std::min(std::max(x1, x2), std::max(y1, y2)), std::min(std::max(z1, z2), maxT));
+        out[i] = tEnter <= tExit ? tEnter : miss;
+    }
+}
+
+bool rayTriangle(const Ray& ray, const glm::vec3& a, const glm::vec3& b, const glm::vec3& c, float maxT,
+    float& t, float& u, float& v)
+{
+    const glm::vec3 e1 = b - a, e2 = c - a;
+    const glm::vec3 p = glm::cross(ray.dir, e2);
+    const float det = glm::dot(e1, p);
+    if (std::fabs(det) < 1e-12f) return false;   // parallel to the triangle (or degenerate)
+    const float inv = 1.0f / det;
+    const glm::vec3 s = ray.origin - a;
+    u = glm::dot(s, p) * inv;
+    if (u < 0.0f || u > 1.0f) return false;
+    const glm::vec3 q = glm::cross(s, e1);
+    v = glm::dot(ray.dir, q) * inv;
+    if (v < 0.0f || u + v > 1.0f) return false;
+    t = glm::dot(e2, q) * inv;
+    return t > 0.0f && t < maxT;
+}
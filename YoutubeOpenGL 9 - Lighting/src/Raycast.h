@@ -0,0 +1,41 @@
+#pragma once
+#include <vector>
+#include <glm/glm.hpp>
+#include "Frustum.h"
+
+// A ray for picking: origin + t * dir for t >= 0. FromScreen gives a unit dir, so t is a
+// distance in world units.
+struct Ray {
+    Ray(const glm::vec3& origin, const glm::vec3& dir);
+    // through a window position (top-left origin, as GLFW reports the cursor), from a
+    // view-projection matrix such as Camera::cameraMatrix
+    static Ray FromScreen(const glm::mat4& viewProjection, double x, double y, int width, int height);
+
+    glm::vec3 at(float t) const { return origin + t * dir; }
+
+    glm::vec3 origin, dir;
+    glm::vec3 invDir;   // 1 / dir, zero components replaced by a tiny value, for slab tests
+};
+
+// What a ray query hit. The triangle indexes the body's topology volumeTris (3 particles
+// each, the same order as the render triangles); the barycentrics weight its particles.
+struct RayHit {
+    int body = -1;            // PhysicsWorld body index
+    int triangle = -1;
+    glm::vec3 barycentric = glm::vec3(0.0f);
+    float t = 0.0f;
+    glm::vec3 point = glm::vec3(0.0f);
+    int particle = -1;        // the triangle's particle nearest to the hit point
+};
+
+// Where the ray enters the box (0 when it starts inside), if it does within [0, maxT].
+bool rayBox(const Ray& ray, const glm::vec3& mn, const glm::vec3& mx, float maxT, float& enter);
+
+// enter[i] = rayBox's entry distance into box i, or +infinity on a miss; enter is resized
+// to boxes.size(). One branch-free pass, like Frustum::cull, so it vectorizes.
+void rayBoxes(const Ray& ray, const BoxList& boxes, float maxT, std::vector<float>& enter);
+
+// Moller-Trumbore, either side facing: the hit distance in (0, maxT) and the barycentrics
+// u, v of b and c.
+bool rayTriangle(const Ray& ray, const glm::vec3& a, const glm::vec3& b, const glm::vec3& c, float maxT,
+    float& t, float& u, float& v);
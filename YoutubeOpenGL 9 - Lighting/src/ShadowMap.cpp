@@ -0,0 +1,100 @@
+#include "ShadowMap.h"
+#include <glm/gtc/matrix_transform.hpp>
+
+namespace {
+
+GLuint makeDepthTexture(int size)
+{
+    GLuint tex = 0;
+    glGenTextures(1, &tex);
+    glBindTexture(GL_TEXTURE_2D, tex);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT24, size, size, 0, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+    // depth comparison in the sampler (sampler2DShadow); linear filtering makes it a 2x2 PCF
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    // outside the map counts as lit
+    const float farDepth[] = { 1.0f, 1.0f, 1.0f, 1.0f };
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+    glTexParameterfv(GL_TEXTURE_2D, GL_TEXTURE_BORDER_COLOR, farDepth);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    return tex;
+}
+
+} // namespace
+
+ShadowMap::ShadowMap(int size_) : size(size_)
+{
+    staticDepth = makeDepthTexture(size);
+    dynamicDepth = makeDepthTexture(size);
+
+    // depth only: one framebuffer, the layer being rendered is attached before each pass
+    glGenFramebuffers(1, &fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, staticDepth, 0);
+    glDrawBuffer(GL_NONE);
+    glReadBuffer(GL_NONE);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+ShadowMap::~ShadowMap()
+{
+    if (fbo) glDeleteFramebuffers(1, &fbo);
+    const GLuint textures[] = { staticDepth, dynamicDepth };
+    glDeleteTextures(2, textures);
+}
+
+void ShadowMap::setLight(const glm::vec3& position, const glm::vec3& target, float fov, float nearPlane, float farPlane)
+{
+    // straight down would make lookAt's up vector degenerate
+    const glm::vec3 dir = glm::normalize(target - position);
+    const glm::vec3 up = glm::abs(dir.y) > 0.99f ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+    const glm::mat4 m = glm::perspective(glm::radians(fov), 1.0f, nearPlane, farPlane) * glm::lookAt(position, target, up);
+    if (m != matrix) staticValid = false;
+    matrix = m;
+}
+
+bool ShadowMap::updateStatic(const std::function<void()>& draw)
+{
+    if (staticValid) return false;
+    renderLayer(staticDepth, draw);
+    staticValid = true;
+    ++staticRenders;
+    return true;
+}
+
+void ShadowMap::updateDynamic(const std::function<void()>& draw)
+{
+    renderLayer(dynamicDepth, draw);
+}
+
+void ShadowMap::Bind()
+{
+    glActiveTexture(GL_TEXTURE0 + staticTextureUnit);
+    glBindTexture(GL_TEXTURE_2D, staticDepth);
+    glActiveTexture(GL_TEXTURE0 + dynamicTextureUnit);
+    glBindTexture(GL_TEXTURE_2D, dynamicDepth);
+    glActiveTexture(GL_TEXTURE0);
+}
+
+void ShadowMap::renderLayer(GLuint texture, const std::function<void()>& draw)
+{
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, texture, 0);
+    glViewport(0, 0, size, size);
+    glClear(GL_DEPTH_BUFFER_BIT);
+    // slope-scaled offset against shadow acne, so the shader needs only a small bias
+    glEnable(GL_POLYGON_OFFSET_FILL);
+    glPolygonOffset(2.0f, 4.0f);
+
+    draw();
+
+    glDisable(GL_POLYGON_OFFSET_FILL);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+}
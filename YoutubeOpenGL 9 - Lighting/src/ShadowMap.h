@@ -0,0 +1,47 @@
+#pragma once
+#include <functional>
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include "Frustum.h"
+
+// Depth maps for one spot-style light, in two layers: static casters are rendered into a
+// cached map only when the light or the static scene changes, and each frame only the moving
+// casters are rendered into a second map. default.frag samples both and takes the darker, so
+// a frame's shadow cost scales with the moving bodies rather than the whole scene.
+class ShadowMap {
+public:
+    static constexpr GLint staticTextureUnit = 2;   // default.frag's "shadowStatic"
+    static constexpr GLint dynamicTextureUnit = 3;  // default.frag's "shadowDynamic"
+
+    explicit ShadowMap(int size = 2048);
+    ~ShadowMap();
+    ShadowMap(const ShadowMap&) = delete;
+    ShadowMap& operator=(const ShadowMap&) = delete;
+
+    // A perspective light at `position` looking at `target`; fov in degrees. The static layer
+    // is re-rendered on the next updateStatic if this differs from the current light.
+    void setLight(const glm::vec3& position, const glm::vec3& target, float fov, float nearPlane, float farPlane);
+    void invalidateStatic() { staticValid = false; }   // the static casters changed
+
+    // Re-renders the static layer if it is out of date; `draw` issues the static casters'
+    // draw calls with a depth program using lightMatrix(). True if it ran.
+    bool updateStatic(const std::function<void()>& draw);
+    // Re-renders the dynamic layer (every frame), same contract as updateStatic
+    void updateDynamic(const std::function<void()>& draw);
+
+    void Bind();   // both layers on their texture units
+
+    const glm::mat4& lightMatrix() const { return matrix; }    // world -> light clip space
+    Frustum lightFrustum() const { return Frustum::FromMatrix(matrix); }
+    int staticRenderCount() const { return staticRenders; }
+
+private:
+    void renderLayer(GLuint texture, const std::function<void()>& draw);
+
+    int size;
+    GLuint fbo = 0;
+    GLuint staticDepth = 0, dynamicDepth = 0;
+    glm::mat4 matrix = glm::mat4(1.0f);
+    bool staticValid = false;
+    int staticRenders = 0;
+};
@@ -0,0 +1,380 @@
+#include "SignedDistanceField.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// On-disk layout: this header, then nx*ny*nz floats, x fastest.
+struct FileHeader {
+    char     magic[4];   // "JSDF"
+    uint32_t version;
+    uint64_t meshHash;
+    int32_t  nx, ny, nz;
+    float    origin[3];
+    float    cellSize;
+    uint32_t reserved;   // keeps the header 48 bytes, so the samples stay aligned
+};
+static_assert(sizeof(FileHeader) == 48, "FileHeader layout");
+
+const uint32_t FILE_VERSION = 1;
+
+// ---- read-only file mapping ----
+
+void* mapFile(const std::string& path, size_t& size)
+{
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return nullptr;
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) { CloseHandle(file); return nullptr; }
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (!mapping) return nullptr;
+    void* base = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping); // the view keeps the mapping alive
+    size = (size_t)fileSize.QuadPart;
+    return base;
+#else
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return nullptr;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) { close(fd); return nullptr; }
+    void* base = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); // so does the mapping
+    if (base == MAP_FAILED) return nullptr;
+    size = (size_t)st.st_size;
+    return base;
+#endif
+}
+
+void unmapFile(void* base, size_t size)
+{
+#ifdef _WIN32
+    (void)size;
+    UnmapViewOfFile(base);
+#else
+    munmap(base, size);
+#endif
+}
+
+// ---- geometry ----
+
+// closest point to p on triangle abc (Ericson, Real-Time Collision Detection 5.1.5)
+glm::vec3 closestOnTriangle(const glm::vec3& p, const glm::vec3& a, const glm::vec3& b, const glm::vec3& c)
+{
+    const glm::vec3 ab = b - a, ac = c - a, ap = p - a;
+    const float d1 = glm::dot(ab, ap), d2 = glm::dot(ac, ap);
+    if (d1 <= 0.0f && d2 <= 0.0f) return a;
+
+    const glm::vec3 bp = p - b;
+    const float d3 = glm::dot(ab, bp), d4 = glm::dot(ac, bp);
+    if (d3 >= 0.0f && d4 <= d3) return b;
+
+    const float vc = d1 * d4 - d3 * d2;
+    if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f) return a + ab * (d1 / (d1 - d3));
+
+    const glm::vec3 cp = p - c;
+    const float d5 = glm::dot(ab, cp), d6 = glm::dot(ac, cp);
+    if (d6 >= 0.0f && d5 <= d6) return c;
+
+    const float vb = d5 * d2 - d1 * d6;
+    if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f) return a + ac * (d2 / (d2 - d6));
+
+    const float va = d3 * d6 - d5 * d4;
+    if (va <= 0.0f && d4 - d3 >= 0.0f && d5 - d6 >= 0.0f)
+        return b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+
+    const float denom = 1.0f / (va + vb + vc);
+    return a + ab * (vb * denom) + ac * (vc * denom);
+}
+
+// Sign of the 2D cross product of (x1, y1) and (x2, y2), with exact zeros broken by a
+// fixed rule so that a ray through a shared edge or vertex is counted by exactly one of
+// the triangles around it.
+int orientation(double x1, double y1, double x2, double y2, double& twiceArea)
+{
+    twiceArea = y1 * x2 - x1 * y2;
+    if (twiceArea > 0) return 1;
+    if (twiceArea < 0) return -1;
+    if (y2 > y1) return 1;
+    if (y2 < y1) return -1;
+    if (x1 > x2) return 1;
+    if (x1 < x2) return -1;
+    return 0;
+}
+
+// Is (x0, y0) inside the 2D triangle? If so, also its barycentric coordinates.
+bool pointInTriangle2D(double x0, double y0, double x1, double y1, double x2, double y2, double x3, double y3,
+    double& a, double& b, double& c)
+{
+    x1 -= x0; x2 -= x0; x3 -= x0;
+    y1 -= y0; y2 -= y0; y3 -= y0;
+    const int sa = orientation(x2, y2, x3, y3, a);
+    if (sa == 0) return false;
+    if (orientation(x3, y3, x1, y1, b) != sa) return false;
+    if (orientation(x1, y1, x2, y2, c) != sa) return false;
+    const double sum = a + b + c;
+    if (sum == 0) return false;
+    a /= sum; b /= sum; c /= sum;
+    return true;
+}
+
+} // namespace
+
+uint64_t SignedDistanceField::MeshHash(const std::vector<glm::vec3>& vertices, const std::vector<uint32_t>& indices,
+    float cellSize, float padding)
+{
+    // FNV-1a over the raw bytes
+    uint64_t h = 1469598103934665603ull;
+    auto mix = [&h](const void* data, size_t bytes) {
+        const unsigned char* p = (const unsigned char*)data;
+        for (size_t i = 0; i < bytes; ++i) { h ^= p[i]; h *= 1099511628211ull; }
+        };
+    mix(vertices.data(), vertices.size() * sizeof(glm::vec3));
+    mix(indices.data(), indices.size() * sizeof(uint32_t));
+    mix(&cellSize, sizeof(cellSize));
+    mix(&padding, sizeof(padding));
+    mix(&FILE_VERSION, sizeof(FILE_VERSION));
+    return h;
+}
+
+std::shared_ptr<const SignedDistanceField> SignedDistanceField::Bake(const std::vector<glm::vec3>& vertices,
+    const std::vector<uint32_t>& indices, float cellSize, float padding)
+{
+    const int triCount = (int)(indices.size() / 3);
+    if (vertices.empty() || triCount == 0 || !(cellSize > 0.0f)) return nullptr;
+
+    glm::vec3 mn = vertices[0], mx = vertices[0];
+    for (const glm::vec3& v : vertices) { mn = glm::min(mn, v); mx = glm::max(mx, v); }
+
+    std::shared_ptr<SignedDistanceField> sdf(new SignedDistanceField());
+    sdf->origin = mn - glm::vec3(padding);
+    sdf->cellSize = cellSize;
+    const glm::vec3 extent = (mx - mn + 2.0f * padding) / cellSize;
+    sdf->nx = std::max(2, (int)std::ceil(extent.x) + 1);
+    sdf->ny = std::max(2, (int)std::ceil(extent.y) + 1);
+    sdf->nz = std::max(2, (int)std::ceil(extent.z) + 1);
+    sdf->meshHash = MeshHash(vertices, indices, cellSize, padding);
+
+    const int nx = sdf->nx, ny = sdf->ny, nz = sdf->nz;
+    const glm::vec3 origin = sdf->origin;
+    auto index = [&](int i, int j, int k) { return ((size_t)k * ny + j) * nx + i; };
+    auto node = [&](int i, int j, int k) { return origin + cellSize * glm::vec3(i, j, k); };
+    auto triDistance = [&](int t, const glm::vec3& p) {
+        const glm::vec3& a = vertices[indices[3 * t]];
+        const glm::vec3& b = vertices[indices[3 * t + 1]];
+        const glm::vec3& c = vertices[indices[3 * t + 2]];
+        return glm::length(p - closestOnTriangle(p, a, b, c));
+        };
+    auto cellRange = [&](float lo, float hi, float o, int n, int band, int& first, int& last) {
+        first = std::max(0, (int)std::floor((lo - o) / cellSize) - band);
+        last = std::min(n - 1, (int)std::ceil((hi - o) / cellSize) + band);
+        };
+
+    std::vector<float>& phi = sdf->owned;
+    phi.assign(sdf->sampleCount(), (float)(nx + ny + nz) * cellSize);
+    std::vector<int> closest(phi.size(), -1);
+    std::vector<int> crossings(phi.size(), 0);
+
+    for (int t = 0; t < triCount; ++t) {
+        const glm::vec3& a = vertices[indices[3 * t]];
+        const glm::vec3& b = vertices[indices[3 * t + 1]];
+        const glm::vec3& c = vertices[indices[3 * t + 2]];
+        const glm::vec3 tmin = glm::min(a, glm::min(b, c)), tmax = glm::max(a, glm::max(b, c));
+
+        // exact distances for the nodes within a cell of the triangle
+        int i0, i1, j0, j1, k0, k1;
+        cellRange(tmin.x, tmax.x, origin.x, nx, 1, i0, i1);
+        cellRange(tmin.y, tmax.y, origin.y, ny, 1, j0, j1);
+        cellRange(tmin.z, tmax.z, origin.z, nz, 1, k0, k1);
+        for (int k = k0; k <= k1; ++k)
+            for (int j = j0; j <= j1; ++j)
+                for (int i = i0; i <= i1; ++i) {
+                    const size_t n = index(i, j, k);
+                    const float d = glm::length(node(i, j, k) - closestOnTriangle(node(i, j, k), a, b, c));
+                    if (d < phi[n]) { phi[n] = d; closest[n] = t; }
+                }
+
+        // where the +x rays along the grid lines cross it: the crossing is counted at the
+        // first node past it
+        j0 = std::max(0, (int)std::ceil((tmin.y - origin.y) / cellSize));
+        j1 = std::min(ny - 1, (int)std::floor((tmax.y - origin.y) / cellSize));
+        k0 = std::max(0, (int)std::ceil((tmin.z - origin.z) / cellSize));
+        k1 = std::min(nz - 1, (int)std::floor((tmax.z - origin.z) / cellSize));
+        for (int k = k0; k <= k1; ++k)
+            for (int j = j0; j <= j1; ++j) {
+                const double y = origin.y + (double)cellSize * j, z = origin.z + (double)cellSize * k;
+                double wa, wb, wc;
+                if (!pointInTriangle2D(y, z, a.y, a.z, b.y, b.z, c.y, c.z, wa, wb, wc)) continue;
+                const double x = wa * a.x + wb * b.x + wc * c.x;
+                const int i = std::max(0, (int)std::ceil((x - origin.x) / cellSize));
+                if (i < nx) ++crossings[index(i, j, k)];
+            }
+    }
+
+    // Fast sweeping: hand each node's closest triangle on to its neighbours, in all eight
+    // diagonal orders, twice (Bridson's makelevelset3).
+    for (int pass = 0; pass < 2; ++pass)
+        for (int order = 0; order < 8; ++order) {
+            const int di = (order & 1) ? -1 : 1, dj = (order & 2) ? -1 : 1, dk = (order & 4) ? -1 : 1;
+            const int is = di > 0 ? 1 : nx - 2, ie = di > 0 ? nx : -1;
+            const int js = dj > 0 ? 1 : ny - 2, je = dj > 0 ? ny : -1;
+            const int ks = dk > 0 ? 1 : nz - 2, ke = dk > 0 ? nz : -1;
+            for (int k = ks; k != ke; k += dk)
+                for (int j = js; j != je; j += dj)
+                    for (int i = is; i != ie; i += di) {
+                        const size_t n = index(i, j, k);
+                        const glm::vec3 p = node(i, j, k);
+                        const size_t neighbours[7] = {
+                            index(i - di, j, k), index(i, j - dj, k), index(i - di, j - dj, k),
+                            index(i, j, k - dk), index(i - di, j, k - dk), index(i, j - dj, k - dk),
+                            index(i - di, j - dj, k - dk) };
+                        for (size_t m : neighbours) {
+                            const int t = closest[m];
+                            if (t < 0 || t == closest[n]) continue;
+                            const float d = triDistance(t, p);
+                            if (d < phi[n]) { phi[n] = d; closest[n] = t; }
+                        }
+                    }
+        }
+
+    // inside where an odd number of crossings lie to the left along x
+    for (int k = 0; k < nz; ++k)
+        for (int j = 0; j < ny; ++j) {
+            int total = 0;
+            for (int i = 0; i < nx; ++i) {
+                const size_t n = index(i, j, k);
+                total += crossings[n];
+                if (total & 1) phi[n] = -phi[n];
+            }
+        }
+
+    sdf->values = phi.data();
+    return sdf;
+}
+
+std::shared_ptr<const SignedDistanceField> SignedDistanceField::Load(const std::string& path, uint64_t meshHash)
+{
+    size_t size = 0;
+    void* base = mapFile(path, size);
+    if (!base) return nullptr;
+
+    FileHeader h;
+    bool ok = size >= sizeof(FileHeader);
+    if (ok) {
+        std::memcpy(&h, base, sizeof(h));
+        ok = std::memcmp(h.magic, "JSDF", 4) == 0 && h.version == FILE_VERSION &&
+            h.nx >= 2 && h.ny >= 2 && h.nz >= 2 && h.cellSize > 0.0f &&
+            size == sizeof(FileHeader) + (size_t)h.nx * h.ny * h.nz * sizeof(float) &&
+            (meshHash == 0 || h.meshHash == meshHash);
+    }
+    if (!ok) { unmapFile(base, size); return nullptr; }
+
+    std::shared_ptr<SignedDistanceField> sdf(new SignedDistanceField());
+    sdf->nx = h.nx; sdf->ny = h.ny; sdf->nz = h.nz;
+    sdf->origin = glm::vec3(h.origin[0], h.origin[1], h.origin[2]);
+    sdf->cellSize = h.cellSize;
+    sdf->meshHash = h.meshHash;
+    sdf->mappedBase = base;
+    sdf->mappedSize = size;
+    sdf->values = (const float*)((const char*)base + sizeof(FileHeader));
+    return sdf;
+}
+
+std::shared_ptr<const SignedDistanceField> SignedDistanceField::LoadOrBake(const std::string& path,
+    const std::vector<glm::vec3>& vertices, const std::vector<uint32_t>& indices, float cellSize, float padding)
+{
+    if (auto cached = Load(path, MeshHash(vertices, indices, cellSize, padding))) return cached;
+
+    auto sdf = Bake(vertices, indices, cellSize, padding);
+    if (sdf && !sdf->save(path))
+        std::cout << "SignedDistanceField: could not write " << path << std::endl;
+    return sdf;
+}
+
+bool SignedDistanceField::save(const std::string& path) const
+{
+    FileHeader h;
+    std::memset(&h, 0, sizeof(h));
+    std::memcpy(h.magic, "JSDF", 4);
+    h.version = FILE_VERSION;
+    h.meshHash = meshHash;
+    h.nx = nx; h.ny = ny; h.nz = nz;
+    h.origin[0] = origin.x; h.origin[1] = origin.y; h.origin[2] = origin.z;
+    h.cellSize = cellSize;
+
+    // written to a temporary and renamed, so a reader never maps a half-written file
+    const std::string tmp = path + ".tmp";
+    FILE* f = std::fopen(tmp.c_str(), "wb");
+    if (!f) return false;
+    bool ok = std::fwrite(&h, sizeof(h), 1, f) == 1 &&
+        std::fwrite(values, sizeof(float), sampleCount(), f) == sampleCount();
+    ok = std::fclose(f) == 0 && ok;
+    if (ok) {
+        std::remove(path.c_str()); // rename does not replace on Windows
+        ok = std::rename(tmp.c_str(), path.c_str()) == 0;
+    }
+    if (!ok) std::remove(tmp.c_str());
+    return ok;
+}
+
+SignedDistanceField::~SignedDistanceField()
+{
+    if (mappedBase) unmapFile(mappedBase, mappedSize);
+}
+
+float SignedDistanceField::sample(const glm::vec3& x, glm::vec3* gradient) const
+{
+    const glm::vec3 g = (x - origin) / cellSize;
+    const glm::vec3 gc = glm::clamp(g, glm::vec3(0.0f), glm::vec3(nx - 1, ny - 1, nz - 1));
+    const int i = std::min((int)gc.x, nx - 2);
+    const int j = std::min((int)gc.y, ny - 2);
+    const int k = std::min((int)gc.z, nz - 2);
+    const float fx = gc.x - (float)i, fy = gc.y - (float)j, fz = gc.z - (float)k;
+
+    const float c000 = at(i, j, k), c100 = at(i + 1, j, k);
+    const float c010 = at(i, j + 1, k), c110 = at(i + 1, j + 1, k);
+    const float c001 = at(i, j, k + 1), c101 = at(i + 1, j, k + 1);
+    const float c011 = at(i, j + 1, k + 1), c111 = at(i + 1, j + 1, k + 1);
+
+    const float c00 = c000 + (c100 - c000) * fx, c10 = c010 + (c110 - c010) * fx;
+    const float c01 = c001 + (c101 - c001) * fx, c11 = c011 + (c111 - c011) * fx;
+    const float c0 = c00 + (c10 - c00) * fy, c1 = c01 + (c11 - c01) * fy;
+    float d = c0 + (c1 - c0) * fz;
+
+    const glm::vec3 out = (g - gc) * cellSize;
+    const float outside = glm::length(out);
+    d += outside;
+
+    if (gradient) {
+        glm::vec3 grad;
+        grad.x = ((c100 - c000) * (1.0f - fy) + (c110 - c010) * fy) * (1.0f - fz) +
+            ((c101 - c001) * (1.0f - fy) + (c111 - c011) * fy) * fz;
+        grad.y = (c10 - c00) * (1.0f - fz) + (c11 - c01) * fz;
+        grad.z = c1 - c0;
+        grad /= cellSize;
+        if (outside > 0.0f) {
+            // clamped axes only see the distance to the grid box
+            for (int c = 0; c < 3; ++c)
+                if (out[c] != 0.0f) grad[c] = 0.0f;
+            grad += out / outside;
+        }
+        *gradient = grad;
+    }
+    return d;
+}
@@ -0,0 +1,65 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+
+// A signed distance field sampled on a regular grid, baked from a static triangle mesh so
+// that colliding with it costs one trilinear lookup per particle however many triangles
+// the mesh has. Negative inside the mesh.
+//
+// Baking voxelizes the mesh (exact distances near each triangle, fast sweeping for the
+// rest, inside/outside by ray parity), so the mesh must be closed. The result can be saved
+// and is memory-mapped when loaded back, so a baked scene costs no parsing at startup.
+class SignedDistanceField {
+public:
+    // indices: 3 per triangle. The grid covers the mesh bounds plus `padding` on every side,
+    // one sample every cellSize.
+    static std::shared_ptr<const SignedDistanceField> Bake(const std::vector<glm::vec3>& vertices,
+        const std::vector<uint32_t>& indices, float cellSize, float padding);
+
+    // Maps a file written by save(). Returns null if it is missing, malformed, or was baked
+    // from something else (meshHash != 0 and different).
+    static std::shared_ptr<const SignedDistanceField> Load(const std::string& path, uint64_t meshHash = 0);
+
+    // The cached field at `path` when it matches this mesh and these parameters; otherwise
+    // bakes it and writes the cache.
+    static std::shared_ptr<const SignedDistanceField> LoadOrBake(const std::string& path,
+        const std::vector<glm::vec3>& vertices, const std::vector<uint32_t>& indices, float cellSize, float padding);
+
+    // identifies a mesh plus bake parameters (what the cache is keyed on)
+    static uint64_t MeshHash(const std::vector<glm::vec3>& vertices, const std::vector<uint32_t>& indices,
+        float cellSize, float padding);
+
+    bool save(const std::string& path) const;
+
+    // Trilinear distance, and its gradient (not normalized) when asked. Outside the grid the
+    // field is continued by adding the distance to the grid box: an overestimate, but the
+    // padding keeps the surface itself well inside.
+    float sample(const glm::vec3& x, glm::vec3* gradient = nullptr) const;
+    float distance(const glm::vec3& x) const { return sample(x); }
+
+    glm::vec3 boundsMin() const { return origin; }
+    glm::vec3 boundsMax() const { return origin + cellSize * glm::vec3(nx - 1, ny - 1, nz - 1); }
+    size_t sampleCount() const { return (size_t)nx * ny * nz; }
+    bool isMapped() const { return mappedBase != nullptr; }
+
+    ~SignedDistanceField();
+    SignedDistanceField(const SignedDistanceField&) = delete;
+    SignedDistanceField& operator=(const SignedDistanceField&) = delete;
+
+    int nx = 0, ny = 0, nz = 0;
+    glm::vec3 origin{ 0.0f };
+    float cellSize = 0.0f;
+    uint64_t meshHash = 0;
+
+private:
+    SignedDistanceField() = default;
+    float at(int i, int j, int k) const { return values[((size_t)k * ny + j) * nx + i]; }
+
+    const float* values = nullptr;   // into owned, or into the mapped file
+    std::vector<float> owned;
+    void* mappedBase = nullptr;
+    size_t mappedSize = 0;
+};
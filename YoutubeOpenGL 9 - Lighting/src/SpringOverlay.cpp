@@ -0,0 +1,75 @@
+#include "SpringOverlay.h"
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include "JellyMeshPool.h"
+
+SpringOverlay::SpringOverlay()
+    : shader("springs.vert", "springs.frag"), springs({ { 2 * sizeof(uint32_t), GL_STATIC_DRAW } }, 1 << 12)
+{
+    glGenTextures(1, &springTex);
+    shader.Activate();
+    glUniform1i(glGetUniformLocation(shader.ID, "positions"), JellyMeshPool::positionTextureUnit);
+    glUniform1i(glGetUniformLocation(shader.ID, "positionTexels"), JellyMeshPool::PositionTexels());
+    glUniform1i(glGetUniformLocation(shader.ID, "springs"), springTextureUnit);
+    particleBaseLoc = glGetUniformLocation(shader.ID, "particleBase");
+    springFirstLoc = glGetUniformLocation(shader.ID, "springFirst");
+    setStrainScale(0.05f);
+}
+
+SpringOverlay::~SpringOverlay()
+{
+    uploaded.clear();   // the ranges go back before the arena goes
+    glDeleteTextures(1, &springTex);
+    shader.Delete();
+}
+
+void SpringOverlay::setStrainScale(float strain)
+{
+    glUniform1f(glGetUniformLocation(shader.ID, "strainScale"), strain);
+}
+
+void SpringOverlay::begin()
+{
+    for (auto it = uploaded.begin(); it != uploaded.end();) {
+        if (it->first.expired()) it = uploaded.erase(it);
+        else ++it;
+    }
+    lines.Bind();
+    glActiveTexture(GL_TEXTURE0 + springTextureUnit);
+    glBindTexture(GL_TEXTURE_BUFFER, springTex);
+    glActiveTexture(GL_TEXTURE0);
+}
+
+void SpringOverlay::draw(const std::shared_ptr<const JellyTopology>& topo, GLint particleBase)
+{
+    if (topo->springEnds16.empty() || topo->springCount() == 0) return;
+
+    auto it = uploaded.find(topo);
+    if (it == uploaded.end()) {
+        std::vector<uint32_t> packed(2 * (size_t)topo->springCount());
+        for (int s = 0; s < topo->springCount(); ++s) {
+            packed[2 * s] = (uint32_t)topo->springEnds16[2 * s] | ((uint32_t)topo->springEnds16[2 * s + 1] << 16);
+            std::memcpy(&packed[2 * s + 1], &topo->springRest[s], sizeof(float));
+        }
+        GpuArena::Range range = springs.allocate(topo->springCount());
+        springs.upload(range, 0, packed.data(), topo->springCount());
+        it = uploaded.emplace(topo, std::move(range)).first;
+    }
+    if (attachedGeneration != springs.generation()) {
+        // re-attach after the arena grew or moved, so the texture sees its new size
+        glActiveTexture(GL_TEXTURE0 + springTextureUnit);
+        glTexBuffer(GL_TEXTURE_BUFFER, GL_RG32UI, springs.buffer(0));
+        glActiveTexture(GL_TEXTURE0);
+        attachedGeneration = springs.generation();
+    }
+
+    glUniform1i(particleBaseLoc, particleBase);
+    glUniform1i(springFirstLoc, (GLint)it->second.first());
+    glDrawArrays(GL_LINES, 0, 2 * topo->springCount());
+}
+
+void SpringOverlay::end()
+{
+    lines.Unbind();
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include <map>
+#include <memory>
+#include <glad/glad.h>
+#include "GpuArena.h"
+#include "JellyTopology.h"
+#include "shaderClass.h"
+#include "VAO.h"
+
+// Debug view of the jellies' spring networks: one line per spring, colored by its strain
+// |len - rest| / rest from blue (at rest) through green to red (strainScale and beyond).
+// Nothing is built or uploaded per frame: the lines read their ends from the position
+// buffer the jellies already draw from (RenderPath::ParticleBuffer), and each topology's
+// springs sit once in a static texture buffer, as (i | j << 16, rest length bits), which
+// springs.vert walks by gl_VertexID and computes the strain from. Topologies whose
+// particle indices need more than 16 bits are skipped.
+class SpringOverlay {
+public:
+    static constexpr GLint springTextureUnit = 7;  // unit of springs.vert's "springs"
+
+    SpringOverlay();
+    ~SpringOverlay();
+    SpringOverlay(const SpringOverlay&) = delete;
+    SpringOverlay& operator=(const SpringOverlay&) = delete;
+
+    // shader active and the jelly pool bound (for its position texture); gives back the
+    // ranges of topologies no body uses any more
+    void begin();
+    // the springs of one body whose particles start at particleBase in the position buffer;
+    // a topology's springs are uploaded the first time it is drawn and kept while it lives
+    void draw(const std::shared_ptr<const JellyTopology>& topo, GLint particleBase);
+    void end();
+
+    Shader shader;   // springs.vert / springs.frag; "camMatrix" is the caller's to set
+    void setStrainScale(float strain);   // the strain drawn fully red (default 0.05); shader active
+
+private:
+    GpuArena springs;                  // declared before the entries, which hold ranges of it
+    // weak, so the overlay does not keep topologies alive; an expired key still orders by
+    // its control block, so it cannot collide with a new topology at the same address
+    std::map<std::weak_ptr<const JellyTopology>, GpuArena::Range, std::owner_less<>> uploaded;
+    VAO lines;                         // no attributes: the lines come from gl_VertexID
+    GLuint springTex = 0;
+    unsigned attachedGeneration = ~0u;
+    GLint particleBaseLoc = -1, springFirstLoc = -1;
+};
@@ -0,0 +1,216 @@
+#include "StaticMesh.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+namespace {
+
+// On-disk layout: this header, then the batches, vertices and indices as in memory.
+struct FileHeader {
+    char     magic[4];   // "JSTM"
+    uint32_t version;
+    uint64_t key;
+    uint32_t batchCount, vertexCount, indexCount;
+    uint32_t reserved;
+};
+static_assert(sizeof(FileHeader) == 32, "FileHeader layout");
+
+struct FileBatch {
+    int32_t  material;
+    uint32_t indexCount;
+    uint64_t firstIndex;
+    float    boundsMin[3], boundsMax[3];
+};
+
+const uint32_t FILE_VERSION = 2;
+
+} // namespace
+
+// ---- StaticMeshBuilder ----
+
+void StaticMeshBuilder::add(int material, const std::vector<StaticVertex>& verts, const std::vector<GLuint>& idx,
+    const glm::mat4& transform)
+{
+    const glm::mat3 normalMatrix = glm::transpose(glm::inverse(glm::mat3(transform)));
+    pieces.push_back({ material, vertices.size(), verts.size(), indices.size(), idx.size() });
+    for (StaticVertex v : verts) {
+        v.pos = glm::vec3(transform * glm::vec4(v.pos, 1.0f));
+        v.normal = glm::normalize(normalMatrix * v.normal);
+        vertices.push_back(v);
+    }
+    indices.insert(indices.end(), idx.begin(), idx.end());
+}
+
+void StaticMeshBuilder::addQuad(int material, glm::vec3 p0, glm::vec3 p1, glm::vec3 p2, glm::vec3 p3, glm::vec3 n,
+    float uTiles, float vTiles, glm::vec3 color)
+{
+    add(material, {
+        { p0, color, glm::vec2(0.0f,   0.0f),   n },
+        { p1, color, glm::vec2(uTiles, 0.0f),   n },
+        { p2, color, glm::vec2(uTiles, vTiles), n },
+        { p3, color, glm::vec2(0.0f,   vTiles), n },
+        }, { 0,1,2, 0,2,3 });
+}
+
+StaticMesh StaticMeshBuilder::build() const
+{
+    // pieces of one material end up next to each other, in the order they were added
+    std::vector<size_t> order(pieces.size());
+    for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return pieces[a].material < pieces[b].material; });
+
+    StaticMesh mesh;
+    mesh.vertices.reserve(vertices.size());
+    mesh.indices.reserve(indices.size());
+    for (size_t o : order) {
+        const Piece& piece = pieces[o];
+        if (mesh.batches.empty() || mesh.batches.back().material != piece.material)
+            mesh.batches.push_back({ piece.material, 0, mesh.indices.size(), glm::vec3(1e30f), glm::vec3(-1e30f) });
+        StaticMesh::Batch& batch = mesh.batches.back();
+        for (size_t v = piece.firstVertex; v < piece.firstVertex + piece.vertexCount; ++v) {
+            batch.boundsMin = glm::min(batch.boundsMin, vertices[v].pos);
+            batch.boundsMax = glm::max(batch.boundsMax, vertices[v].pos);
+        }
+        const GLuint base = (GLuint)mesh.vertices.size();
+        mesh.vertices.insert(mesh.vertices.end(), vertices.begin() + piece.firstVertex,
+            vertices.begin() + piece.firstVertex + piece.vertexCount);
+        for (size_t i = 0; i < piece.indexCount; ++i) mesh.indices.push_back(base + indices[piece.firstIndex + i]);
+        batch.indexCount += (GLsizei)piece.indexCount;
+    }
+    mesh.key = hash();
+    return mesh;
+}
+
+StaticMesh StaticMeshBuilder::buildCached(const std::string& path) const
+{
+    StaticMesh mesh;
+    if (StaticMesh::Load(path, hash(), mesh)) return mesh;
+
+    mesh = build();
+    if (!mesh.save(path))
+        std::cout << "StaticMesh: could not write " << path << std::endl;
+    return mesh;
+}
+
+uint64_t StaticMeshBuilder::hash() const
+{
+    // FNV-1a over the raw bytes
+    uint64_t h = 1469598103934665603ull;
+    auto mix = [&h](const void* data, size_t bytes) {
+        const unsigned char* p = (const unsigned char*)data;
+        for (size_t i = 0; i < bytes; ++i) { h ^= p[i]; h *= 1099511628211ull; }
+        };
+    for (const Piece& piece : pieces) {
+        mix(&piece.material, sizeof(piece.material));
+        mix(&vertices[piece.firstVertex], piece.vertexCount * sizeof(StaticVertex));
+        mix(&indices[piece.firstIndex], piece.indexCount * sizeof(GLuint));
+    }
+    mix(&FILE_VERSION, sizeof(FILE_VERSION));
+    return h;
+}
+
+// ---- StaticMesh ----
+
+bool StaticMesh::Load(const std::string& path, uint64_t key, StaticMesh& out)
+{
+    FILE* f = std::fopen(path.c_str(), "rb");
+    if (!f) return false;
+
+    FileHeader h;
+    bool ok = std::fread(&h, sizeof(h), 1, f) == 1 &&
+        std::memcmp(h.magic, "JSTM", 4) == 0 && h.version == FILE_VERSION && (key == 0 || h.key == key);
+    StaticMesh mesh;
+    if (ok) {
+        std::vector<FileBatch> fileBatches(h.batchCount);
+        mesh.vertices.resize(h.vertexCount);
+        mesh.indices.resize(h.indexCount);
+        ok = std::fread(fileBatches.data(), sizeof(FileBatch), h.batchCount, f) == h.batchCount &&
+            std::fread(mesh.vertices.data(), sizeof(StaticVertex), h.vertexCount, f) == h.vertexCount &&
+            std::fread(mesh.indices.data(), sizeof(GLuint), h.indexCount, f) == h.indexCount &&
+            std::fgetc(f) == EOF;
+        for (const FileBatch& b : fileBatches) {
+            ok = ok && b.firstIndex + b.indexCount <= h.indexCount;
+            mesh.batches.push_back({ b.material, (GLsizei)b.indexCount, (size_t)b.firstIndex,
+                glm::vec3(b.boundsMin[0], b.boundsMin[1], b.boundsMin[2]),
+                glm::vec3(b.boundsMax[0], b.boundsMax[1], b.boundsMax[2]) });
+        }
+        for (GLuint i : mesh.indices) ok = ok && i < h.vertexCount;
+    }
+    std::fclose(f);
+    if (!ok) return false;
+
+    mesh.key = h.key;
+    out = std::move(mesh);
+    return true;
+}
+
+bool StaticMesh::save(const std::string& path) const
+{
+    FileHeader h;
+    std::memset(&h, 0, sizeof(h));
+    std::memcpy(h.magic, "JSTM", 4);
+    h.version = FILE_VERSION;
+    h.key = key;
+    h.batchCount = (uint32_t)batches.size();
+    h.vertexCount = (uint32_t)vertices.size();
+    h.indexCount = (uint32_t)indices.size();
+    std::vector<FileBatch> fileBatches;
+    for (const Batch& b : batches)
+        fileBatches.push_back({ b.material, (uint32_t)b.indexCount, b.firstIndex,
+            { b.boundsMin.x, b.boundsMin.y, b.boundsMin.z }, { b.boundsMax.x, b.boundsMax.y, b.boundsMax.z } });
+
+    // written to a temporary and renamed, so a reader never sees a half-written file
+    const std::string tmp = path + ".tmp";
+    FILE* f = std::fopen(tmp.c_str(), "wb");
+    if (!f) return false;
+    bool ok = std::fwrite(&h, sizeof(h), 1, f) == 1 &&
+        std::fwrite(fileBatches.data(), sizeof(FileBatch), fileBatches.size(), f) == fileBatches.size() &&
+        std::fwrite(vertices.data(), sizeof(StaticVertex), vertices.size(), f) == vertices.size() &&
+        std::fwrite(indices.data(), sizeof(GLuint), indices.size(), f) == indices.size();
+    ok = std::fclose(f) == 0 && ok;
+    if (ok) {
+        std::remove(path.c_str()); // rename does not replace on Windows
+        ok = std::rename(tmp.c_str(), path.c_str()) == 0;
+    }
+    if (!ok) std::remove(tmp.c_str());
+    return ok;
+}
+
+const StaticMesh::Batch* StaticMesh::batch(int material) const
+{
+    for (const Batch& b : batches)
+        if (b.material == material) return &b;
+    return nullptr;
+}
+
+void StaticMesh::Upload()
+{
+    vao = std::make_unique<VAO>();
+    vao->Bind();
+    vbo = std::make_unique<VBO>(vertices.data(), (GLsizeiptr)(vertices.size() * sizeof(StaticVertex)), GL_STATIC_DRAW);
+    ebo = std::make_unique<EBO>(indices.data(), (GLsizeiptr)(indices.size() * sizeof(GLuint)));
+    vao->LinkAttrib(*vbo, 0, 3, GL_FLOAT, sizeof(StaticVertex), (void*)offsetof(StaticVertex, pos));
+    vao->LinkAttrib(*vbo, 1, 3, GL_FLOAT, sizeof(StaticVertex), (void*)offsetof(StaticVertex, color));
+    vao->LinkAttrib(*vbo, 2, 2, GL_FLOAT, sizeof(StaticVertex), (void*)offsetof(StaticVertex, uv));
+    vao->LinkAttrib(*vbo, 3, 3, GL_FLOAT, sizeof(StaticVertex), (void*)offsetof(StaticVertex, normal));
+    vao->Unbind(); vbo->Unbind(); ebo->Unbind();
+}
+
+void StaticMesh::Draw(int material, const Frustum* frustum) const
+{
+    const Batch* b = batch(material);
+    if (!vao || !b) return;
+    if (frustum && !frustum->intersects(b->boundsMin, b->boundsMax)) return;
+    vao->Bind();
+    glDrawElements(GL_TRIANGLES, b->indexCount, GL_UNSIGNED_INT, (void*)(b->firstIndex * sizeof(GLuint)));
+    vao->Unbind();
+}
+
+void StaticMesh::Delete()
+{
+    vao.reset();
+    vbo.reset();
+    ebo.reset();
+}
@@ -0,0 +1,84 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include "VAO.h"
+#include "VBO.h"
+#include "EBO.h"
+#include "Frustum.h"
+
+// One vertex of static geometry, in default.vert's layout (locations 0-3).
+struct StaticVertex {
+    glm::vec3 pos;
+    glm::vec3 color;
+    glm::vec2 uv;
+    glm::vec3 normal;
+};
+static_assert(sizeof(StaticVertex) == 11 * sizeof(float), "StaticVertex layout");
+
+// All static geometry in one vertex and one index buffer, grouped by material, so drawing a
+// material is one glDrawElements however many pieces went into it.
+class StaticMesh {
+public:
+    struct Batch {
+        int material;
+        GLsizei indexCount;
+        size_t firstIndex;    // into indices
+        glm::vec3 boundsMin, boundsMax;
+    };
+
+    // Reads a mesh written by save(). False if it is missing, malformed, or built from
+    // something else (key != 0 and different).
+    static bool Load(const std::string& path, uint64_t key, StaticMesh& out);
+    bool save(const std::string& path) const;
+
+    void Upload();                   // creates the GL buffers (GL thread)
+    // that material's batch, one call, unless its bounds are outside the frustum
+    void Draw(int material, const Frustum* frustum = nullptr) const;
+    void Delete();                   // also happens on destruction
+
+    const Batch* batch(int material) const;
+
+    std::vector<StaticVertex> vertices;
+    std::vector<GLuint> indices;     // absolute, so every batch shares the one vertex buffer
+    std::vector<Batch> batches;      // ascending material
+    uint64_t key = 0;                // what it was built from (StaticMeshBuilder::hash)
+
+private:
+    std::unique_ptr<VAO> vao;
+    std::unique_ptr<VBO> vbo;
+    std::unique_ptr<EBO> ebo;
+};
+
+// Collects static pieces (any order, any material) and merges them into a StaticMesh.
+class StaticMeshBuilder {
+public:
+    // indices are local to `verts`; positions and normals are taken through `transform`
+    void add(int material, const std::vector<StaticVertex>& verts, const std::vector<GLuint>& indices,
+        const glm::mat4& transform = glm::mat4(1.0f));
+
+    // p0..p3 counter-clockwise seen from the front; the texture repeats uTiles x vTiles times
+    void addQuad(int material, glm::vec3 p0, glm::vec3 p1, glm::vec3 p2, glm::vec3 p3, glm::vec3 normal,
+        float uTiles, float vTiles, glm::vec3 color = glm::vec3(1.0f));
+
+    StaticMesh build() const;
+
+    // The mesh cached at `path` when it was built from exactly these pieces; otherwise
+    // builds it and writes the cache.
+    StaticMesh buildCached(const std::string& path) const;
+
+    uint64_t hash() const;   // identifies the pieces (what the cache is keyed on)
+
+private:
+    struct Piece {
+        int material;
+        size_t firstVertex, vertexCount;
+        size_t firstIndex, indexCount;
+    };
+    std::vector<Piece> pieces;
+    std::vector<StaticVertex> vertices;  // transformed
+    std::vector<GLuint> indices;         // local to their piece
+};
@@ -0,0 +1,114 @@
+#include "Telemetry.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+namespace {
+
+// the records of one step: [first, last) in the deque
+std::pair<std::deque<BodyStepStats>::const_iterator, std::deque<BodyStepStats>::const_iterator>
+stepRange(const std::deque<BodyStepStats>& records, int step)
+{
+    const auto first = std::lower_bound(records.begin(), records.end(), step,
+        [](const BodyStepStats& r, int s) { return r.step < s; });
+    auto last = first;
+    while (last != records.end() && last->step == step) ++last;
+    return { first, last };
+}
+
+} // namespace
+
+void Telemetry::append(const std::vector<BodyStepStats>& step)
+{
+    records.insert(records.end(), step.begin(), step.end());
+    // drop whole steps from the front
+    while (records.size() > maxRecords) {
+        const int oldest = records.front().step;
+        while (!records.empty() && records.front().step == oldest) records.pop_front();
+    }
+}
+
+std::vector<BodyStepStats> Telemetry::stepRecords(int step) const
+{
+    const auto range = stepRange(records, step);
+    return std::vector<BodyStepStats>(range.first, range.second);
+}
+
+StepTotals Telemetry::totals(int step) const
+{
+    StepTotals t;
+    const auto range = stepRange(records, step);
+    for (auto it = range.first; it != range.second; ++it) {
+        t.step = step;
+        ++t.bodies;
+        t.kinetic += it->kinetic;
+        t.potential += it->potential;
+        if (t.worstBody < 0 || it->maxStrain > t.maxStrain) {
+            t.maxStrain = it->maxStrain;
+            t.worstBody = it->body;
+        }
+        t.maxResidual = std::max(t.maxResidual, it->residual);
+        t.colliderContacts += it->colliderContacts;
+        t.bodyContacts += it->bodyContacts;
+        t.stepUs += it->stepUs;
+    }
+    return t;
+}
+
+std::vector<BodyStepStats> Telemetry::bodyRecords(int body) const
+{
+    std::vector<BodyStepStats> out;
+    for (const BodyStepStats& r : records)
+        if (r.body == body) out.push_back(r);
+    return out;
+}
+
+int Telemetry::firstBlowup(float strainLimit, double energyGrowth) const
+{
+    double previous = 0.0;
+    bool havePrevious = false;
+    for (int s = firstStep(); s >= 0 && s <= lastStep(); ++s) {
+        const StepTotals t = totals(s);
+        if (t.bodies == 0) continue;
+        const double energy = t.kinetic + t.potential;
+        if (t.maxStrain > strainLimit) return s;
+        if (havePrevious && energy - previous > energyGrowth * std::max(std::fabs(previous), 1e-3)) return s;
+        previous = energy;
+        havePrevious = true;
+    }
+    return -1;
+}
+
+bool Telemetry::writeCsv(const std::string& path) const
+{
+    FILE* f = std::fopen(path.c_str(), "w");
+    if (!f) return false;
+    std::fprintf(f, "step,body,kinetic,potential,max_strain,residual,collider_contacts,body_contacts,step_us\n");
+    for (const BodyStepStats& r : records)
+        std::fprintf(f, "%d,%d,%.9g,%.9g,%.9g,%.9g,%d,%d,%.3f\n", r.step, r.body, r.kinetic, r.potential,
+            r.maxStrain, r.residual, r.colliderContacts, r.bodyContacts, r.stepUs);
+    return std::fclose(f) == 0;
+}
+
+bool Telemetry::writeJson(const std::string& path) const
+{
+    FILE* f = std::fopen(path.c_str(), "w");
+    if (!f) return false;
+    std::fprintf(f, "[");
+    bool first = true;
+    for (const BodyStepStats& r : records) {
+        std::fprintf(f, "%s\n{\"step\":%d,\"body\":%d,\"kinetic\":%.9g,\"potential\":%.9g,\"max_strain\":%.9g,"
+            "\"residual\":%.9g,\"collider_contacts\":%d,\"body_contacts\":%d,\"step_us\":%.3f}",
+            first ? "" : ",", r.step, r.body, r.kinetic, r.potential, r.maxStrain, r.residual,
+            r.colliderContacts, r.bodyContacts, r.stepUs);
+        first = false;
+    }
+    std::fprintf(f, "\n]\n");
+    return std::fclose(f) == 0;
+}
+
+bool Telemetry::write(const std::string& path) const
+{
+    const bool json = path.size() >= 5 && path.compare(path.size() - 5, 5, ".json") == 0;
+    return json ? writeJson(path) : writeCsv(path);
+}
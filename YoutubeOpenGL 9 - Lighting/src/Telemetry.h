@@ -0,0 +1,70 @@
+#pragma once
+#include <cstddef>
+#include <deque>
+#include <string>
+#include <vector>
+
+// One body's numbers for one PhysicsWorld step.
+struct BodyStepStats {
+    int   step = 0;              // PhysicsWorld step number
+    int   body = 0;              // body index at that step
+    float kinetic = 0.0f;        // sum of m v^2 / 2, v from the step's displacement
+    float potential = 0.0f;      // gravity, m g y (the PBD springs have no stiffness to count)
+    float maxStrain = 0.0f;      // largest |len - rest| / rest, after the body contacts
+    float residual = 0.0f;       // RMS strain right after Jelly::Step's solver passes
+    int   colliderContacts = 0;  // particles touching a collider at the end of the step
+    int   bodyContacts = 0;      // other bodies it was pushed apart from
+    float stepUs = 0.0f;         // time in Jelly::Step
+};
+
+// A whole step, summed (energies, contacts, time) or at its worst (strain, residual).
+struct StepTotals {
+    int   step = -1;
+    int   bodies = 0;
+    double kinetic = 0.0, potential = 0.0;
+    float maxStrain = 0.0f, maxResidual = 0.0f;
+    int   worstBody = -1;        // the body with maxStrain
+    int   colliderContacts = 0, bodyContacts = 0;
+    double stepUs = 0.0;
+};
+
+// Per step, per body simulation stats, for tuning iteration counts and catching blowups in
+// long runs. A PhysicsWorld fills one while it is attached (world.telemetry = &t); with none
+// attached nothing is measured at all. Only the last maxRecords records are kept, dropping
+// whole steps. Queryable in code, exportable as CSV or JSON.
+class Telemetry {
+public:
+    explicit Telemetry(size_t maxRecords = 1 << 20) : maxRecords(maxRecords) {}
+
+    // one step's records, one per body (PhysicsWorld)
+    void append(const std::vector<BodyStepStats>& step);
+    void clear() { records.clear(); }
+
+    const std::deque<BodyStepStats>& all() const { return records; }
+    bool empty() const { return records.empty(); }
+    int firstStep() const { return records.empty() ? -1 : records.front().step; }
+    int lastStep() const { return records.empty() ? -1 : records.back().step; }
+
+    // the records of one step (empty if it was dropped or never recorded)
+    std::vector<BodyStepStats> stepRecords(int step) const;
+    StepTotals totals(int step) const;
+    // one body across the kept steps, by index
+    std::vector<BodyStepStats> bodyRecords(int body) const;
+    // the first kept step whose worst strain exceeds strainLimit, or whose total energy
+    // (kinetic plus potential, which a damped fall only trades between the two) grows by
+    // more than energyGrowth times its size over the previous step; -1 if none
+    int firstBlowup(float strainLimit = 0.5f, double energyGrowth = 1.0) const;
+
+    // columns step, body, kinetic, potential, max_strain, residual, collider_contacts,
+    // body_contacts, step_us; false if the file could not be written
+    bool writeCsv(const std::string& path) const;
+    // an array of objects with the same fields
+    bool writeJson(const std::string& path) const;
+    // by the path's extension: .json, otherwise CSV
+    bool write(const std::string& path) const;
+
+    size_t maxRecords;
+
+private:
+    std::deque<BodyStepStats> records;   // step by step, bodies ascending within a step
+};
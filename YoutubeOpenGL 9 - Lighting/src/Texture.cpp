@@ -1,21 +1,46 @@
 #include"Texture.h"
 #include <iostream> // Include iostream for error reporting
 
+TextureImage TextureImage::Decode(const char* image)
+{
+	TextureImage img;
+	// Flips the image so it appears right side up (per thread, so decodes can run in parallel)
+	stbi_set_flip_vertically_on_load_thread(true);
+	// Reads the image from a file and stores it in bytes
+	img.bytes = stbi_load(image, &img.width, &img.height, &img.channels, 0);
+	if (!img.bytes)
+		std::cerr << "Failed to load texture: " << image << std::endl;
+	return img;
+}
+
+void TextureImage::Free()
+{
+	stbi_image_free(bytes);
+	bytes = nullptr;
+}
+
 Texture::Texture(const char* image, GLenum texType, GLenum slot, GLenum format, GLenum pixelType)
+{
+	TextureImage img = TextureImage::Decode(image);
+	Upload(img, texType, slot, format, pixelType);
+	img.Free();
+}
+
+Texture::Texture(const TextureImage& image, GLenum texType, GLenum slot, GLenum format, GLenum pixelType)
+{
+	Upload(image, texType, slot, format, pixelType);
+}
+
+void Texture::Upload(const TextureImage& image, GLenum texType, GLenum slot, GLenum format, GLenum pixelType)
 {
 	// Assigns the type of the texture ot the texture object
 	type = texType;
+	ID = 0;
 
 	// Stores the width, height, and the number of color channels of the image
-	int widthImg, heightImg, numColCh;
-	// Flips the image so it appears right side up
-	stbi_set_flip_vertically_on_load(true);
-	// Reads the image from a file and stores it in bytes
-	unsigned char* bytes = stbi_load(image, &widthImg, &heightImg, &numColCh, 0);
-	if (!bytes) {
-		std::cerr << "Failed to load texture: " << image << std::endl;
-		return;
-	}
+	const int widthImg = image.width, heightImg = image.height;
+	const unsigned char* bytes = image.bytes;
+	if (!bytes) return;
 
 	// Generates an OpenGL texture object
 	glGenTextures(1, &ID);
@@ -40,9 +65,6 @@ Texture::Texture(const char* image, GLenum texType, GLenum slot, GLenum format,
 	// Generates MipMaps
 	glGenerateMipmap(texType);
 
-	// Deletes the image data as it is already in the OpenGL Texture object
-	stbi_image_free(bytes);
-
 	// Unbinds the OpenGL Texture object so that it can't accidentally be modified
 	glBindTexture(texType, 0);
 }
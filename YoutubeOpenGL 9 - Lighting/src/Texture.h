@@ -6,12 +6,27 @@
 
 #include"shaderClass.h"
 
+// Pixels decoded from an image file but not uploaded yet. Decoding makes no GL calls, so it
+// can run on a job thread while the GL thread gets on with other setup
+struct TextureImage
+{
+	unsigned char* bytes = nullptr;
+	int width = 0, height = 0, channels = 0;
+
+	// Reads and decodes an image file (flipped so it appears right side up); bytes stays null on failure
+	static TextureImage Decode(const char* image);
+	// Frees the decoded bytes
+	void Free();
+};
+
 class Texture
 {
 public:
 	GLuint ID;
 	GLenum type;
 	Texture(const char* image, GLenum texType, GLenum slot, GLenum format, GLenum pixelType);
+	// Uploads an image that has already been decoded
+	Texture(const TextureImage& image, GLenum texType, GLenum slot, GLenum format, GLenum pixelType);
 
 	// Assigns a texture unit to a texture
 	void texUnit(Shader& shader, const char* uniform, GLuint unit);
@@ -21,5 +36,8 @@ public:
 	void Unbind();
 	// Deletes a texture
 	void Delete();
+
+private:
+	void Upload(const TextureImage& image, GLenum texType, GLenum slot, GLenum format, GLenum pixelType);
 };
 #endif
\ No newline at end of file
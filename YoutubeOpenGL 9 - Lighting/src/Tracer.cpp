@@ -0,0 +1,160 @@
+#include "Tracer.h"
+#include <algorithm>
+#include <cstdio>
+
+namespace {
+
+// the calling thread's ring, per tracer (a thread normally only ever records into one)
+thread_local const Tracer* tlsTracer = nullptr;
+thread_local Tracer::Ring* tlsRing = nullptr;
+thread_local std::string tlsName;   // set before the ring exists
+
+size_t powerOfTwo(size_t n)
+{
+    size_t p = 1;
+    while (p < n) p <<= 1;
+    return p;
+}
+
+// names are ours or literals, but keep the JSON valid whatever they hold
+void writeString(FILE* f, const char* s)
+{
+    std::fputc('"', f);
+    for (; *s; ++s) {
+        if (*s == '"' || *s == '\\') std::fputc('\\', f);
+        if ((unsigned char)*s >= 0x20) std::fputc(*s, f);
+    }
+    std::fputc('"', f);
+}
+
+} // namespace
+
+Tracer::Ring::Ring(std::string name_, int tid_, size_t capacity)
+    : name(std::move(name_)), tid(tid_), slots(powerOfTwo(capacity))
+{
+}
+
+void Tracer::Ring::record(const char* eventName, int64_t start, int64_t end, int64_t arg)
+{
+    const uint64_t n = written.load(std::memory_order_relaxed);
+    // the slot's old event (n - size) counts as gone from here on: a dump that sees the
+    // count at n or later does not trust it (a seqlock, with the count as the sequence)
+    std::atomic_thread_fence(std::memory_order_release);
+    Slot& slot = slots[n & (slots.size() - 1)];
+    slot.name.store(eventName, std::memory_order_relaxed);
+    slot.start.store(start, std::memory_order_relaxed);
+    slot.duration.store(end - start, std::memory_order_relaxed);
+    slot.arg.store(arg, std::memory_order_relaxed);
+    written.store(n + 1, std::memory_order_release);
+}
+
+Tracer::Scope::Scope(const char* name_, int64_t arg_)
+    : name(name_), arg(arg_), start(Tracer::Shared().isEnabled() ? Tracer::Shared().now() : -1)
+{
+}
+
+void Tracer::Scope::end()
+{
+    if (start < 0) return;
+    Tracer& tracer = Tracer::Shared();
+    tracer.threadRing().record(name, start, tracer.now(), arg);
+    start = -1;
+}
+
+Tracer::Tracer(size_t eventsPerThread)
+    : capacity(eventsPerThread), epoch(std::chrono::steady_clock::now())
+{
+}
+
+Tracer& Tracer::Shared()
+{
+    static Tracer shared;
+    return shared;
+}
+
+int64_t Tracer::now() const
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count();
+}
+
+Tracer::Ring& Tracer::addRing(std::string name, bool isLane)
+{
+    std::lock_guard<std::mutex> lock(ringsMtx);
+    // lanes have negative ids, so they never pass for a thread's
+    const int id = (int)rings.size() + 1;
+    rings.emplace_back(new Ring(std::move(name), isLane ? -id : id, capacity));
+    return *rings.back();
+}
+
+Tracer::Ring& Tracer::threadRing()
+{
+    if (tlsTracer != this || !tlsRing) {
+        tlsRing = &addRing(tlsName.empty() ? "thread" : tlsName, false);
+        tlsTracer = this;
+    }
+    return *tlsRing;
+}
+
+Tracer::Ring& Tracer::lane(const std::string& name)
+{
+    {
+        std::lock_guard<std::mutex> lock(ringsMtx);
+        for (const auto& r : rings)
+            if (r->name == name && r->tid < 0) return *r;
+    }
+    return addRing(name, true);
+}
+
+void Tracer::setThreadName(const std::string& name)
+{
+    tlsName = name;
+    if (tlsTracer != this || !tlsRing) return;   // named when it records its first event
+    std::lock_guard<std::mutex> lock(ringsMtx);
+    tlsRing->name = name;
+}
+
+bool Tracer::write(const std::string& path)
+{
+    FILE* f = std::fopen(path.c_str(), "w");
+    if (!f) return false;
+
+    std::lock_guard<std::mutex> lock(ringsMtx);
+    std::fprintf(f, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+    bool first = true;
+    for (const auto& ring : rings) {
+        // lanes sort after the threads
+        const int tid = ring->tid > 0 ? ring->tid : 1000 - ring->tid;
+        std::fprintf(f, "%s\n{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":", first ? "" : ",", tid);
+        writeString(f, ring->name.c_str());
+        std::fprintf(f, "}}");
+        first = false;
+
+        // the newest `size` events; any the producer overwrites while they are copied are
+        // dropped by checking the count again afterwards
+        const uint64_t size = ring->slots.size();
+        const uint64_t end = ring->written.load(std::memory_order_acquire);
+        const uint64_t begin = end > size ? end - size : 0;
+        std::vector<Event> copy;
+        copy.reserve((size_t)(end - begin));
+        for (uint64_t n = begin; n < end; ++n) {
+            const Ring::Slot& slot = ring->slots[n & (size - 1)];
+            copy.push_back({ slot.name.load(std::memory_order_relaxed), slot.start.load(std::memory_order_relaxed),
+                slot.duration.load(std::memory_order_relaxed), slot.arg.load(std::memory_order_relaxed) });
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        // event `after` may be half written over the slot of after - size
+        const uint64_t after = ring->written.load(std::memory_order_relaxed);
+        const uint64_t valid = after + 1 > size ? after + 1 - size : 0;
+
+        for (uint64_t n = std::max(begin, valid); n < end; ++n) {
+            const Event& e = copy[(size_t)(n - begin)];
+            std::fprintf(f, ",\n{\"ph\":\"X\",\"name\":");
+            writeString(f, e.name);
+            std::fprintf(f, ",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f", tid, e.start * 1e-3, e.duration * 1e-3);
+            if (e.arg != noArg) std::fprintf(f, ",\"args\":{\"id\":%lld}", (long long)e.arg);
+            std::fprintf(f, "}");
+        }
+    }
+    std::fprintf(f, "\n]}\n");
+    return std::fclose(f) == 0;
+}
@@ -0,0 +1,90 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Timeline of what every thread (and the GPU, see GpuTrace) was doing, written out as Chrome
+// trace JSON (chrome://tracing, ui.perfetto.dev) to see overlap and stalls that averaged
+// timers hide.
+//
+// Every thread records into its own ring buffer: one producer, no locks, no allocation
+// after the thread's first event, so recording costs two clock reads and a few stores per
+// scope. A scope is stored as one complete event (begin time and duration), so a ring
+// that wraps never leaves a begin without its end. Disabled (the default), a scope costs
+// one relaxed atomic load.
+class Tracer {
+public:
+    struct Event {
+        const char* name;   // must outlive the tracer (string literals)
+        int64_t start;      // ns since the tracer was created
+        int64_t duration;   // ns
+        int64_t arg;        // shown as args.id unless noArg
+    };
+    static constexpr int64_t noArg = INT64_MIN;
+
+    // One ring: a thread's own, or a lane for events a thread records on behalf of
+    // something else (the GPU). Only one thread may record into a ring.
+    class Ring {
+    public:
+        void record(const char* name, int64_t start, int64_t end, int64_t arg = noArg);
+
+    private:
+        friend class Tracer;
+        Ring(std::string name, int tid, size_t capacity);
+        // an Event whose fields a dump may read while they are written (relaxed: the count
+        // tells the dump which slots it can trust)
+        struct Slot {
+            std::atomic<const char*> name{ nullptr };
+            std::atomic<int64_t> start{ 0 }, duration{ 0 }, arg{ 0 };
+        };
+        std::string name;
+        int tid;
+        std::vector<Slot> slots;              // power of two
+        std::atomic<uint64_t> written{ 0 };   // events ever recorded; slot = written & mask
+    };
+
+    // Records the enclosing block on the calling thread's ring of the shared tracer:
+    // Tracer::Scope trace("physics");
+    class Scope {
+    public:
+        explicit Scope(const char* name, int64_t arg = noArg);
+        ~Scope() { end(); }
+        void end();   // records now rather than at the end of the block
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        const char* name;
+        int64_t arg;
+        int64_t start;       // -1: tracing was off when the scope opened
+    };
+
+    explicit Tracer(size_t eventsPerThread = 1 << 16);
+    static Tracer& Shared();
+
+    void setEnabled(bool on) { enabled.store(on, std::memory_order_relaxed); }
+    bool isEnabled() const { return enabled.load(std::memory_order_relaxed); }
+
+    int64_t now() const;   // ns since the tracer was created, on the steady clock
+
+    Ring& threadRing();                    // the calling thread's, created on first use
+    Ring& lane(const std::string& name);   // a named extra ring (created once per name)
+    void setThreadName(const std::string& name);   // allocates nothing until the thread records
+
+    // Writes what the rings hold as Chrome trace JSON; false if the file could not be written.
+    // Safe while other threads record: events overwritten during the dump are left out.
+    bool write(const std::string& path);
+
+private:
+    Ring& addRing(std::string name, bool isLane);
+
+    const size_t capacity;
+    const std::chrono::steady_clock::time_point epoch;
+    std::atomic<bool> enabled{ false };
+    std::mutex ringsMtx;                   // guards rings; taken once per thread, not per event
+    std::vector<std::unique_ptr<Ring>> rings;
+};
@@ -7,12 +7,23 @@ VAO::VAO()
 }
 
 // Links a VBO Attribute such as a position or color to the VAO
-void VAO::LinkAttrib(VBO& VBO, GLuint layout, GLuint numComponents, GLenum type, GLsizeiptr stride, void* offset)
+void VAO::LinkAttrib(VBO& VBO, GLuint layout, GLuint numComponents, GLenum type, GLsizeiptr stride, void* offset,
+	GLboolean normalized, bool integer)
 {
-	VBO.Bind();
-	glVertexAttribPointer(layout, numComponents, type, GL_FALSE, stride, offset);
+	LinkAttrib(VBO.ID, layout, numComponents, type, stride, offset, normalized, integer);
+}
+
+// Links an attribute of a buffer given by name
+void VAO::LinkAttrib(GLuint buffer, GLuint layout, GLuint numComponents, GLenum type, GLsizeiptr stride, void* offset,
+	GLboolean normalized, bool integer)
+{
+	glBindBuffer(GL_ARRAY_BUFFER, buffer);
+	if (integer)
+		glVertexAttribIPointer(layout, numComponents, type, (GLsizei)stride, offset);
+	else
+		glVertexAttribPointer(layout, numComponents, type, normalized, (GLsizei)stride, offset);
 	glEnableVertexAttribArray(layout);
-	VBO.Unbind();
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
 }
 
 // Binds the VAO
@@ -27,8 +38,33 @@ void VAO::Unbind()
 	glBindVertexArray(0);
 }
 
+// Takes over the other's VAO, leaving it empty
+VAO::VAO(VAO&& other) noexcept
+	: ID(other.ID)
+{
+	other.ID = 0;
+}
+
+VAO& VAO::operator=(VAO&& other) noexcept
+{
+	if (this != &other)
+	{
+		Delete();
+		ID = other.ID;
+		other.ID = 0;
+	}
+	return *this;
+}
+
+VAO::~VAO()
+{
+	Delete();
+}
+
 // Deletes the VAO
 void VAO::Delete()
 {
+	if (ID == 0) return;
 	glDeleteVertexArrays(1, &ID);
+	ID = 0;
 }
\ No newline at end of file
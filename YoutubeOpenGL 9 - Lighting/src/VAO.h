@@ -8,17 +8,29 @@ class VAO
 {
 public:
 	// ID reference for the Vertex Array Object
-	GLuint ID;
+	GLuint ID = 0;
 	// Constructor that generates a VAO ID
 	VAO();
+	// Owns its vertex array: move-only, and deleted with the VAO unless Delete() came first
+	VAO(VAO&& other) noexcept;
+	VAO& operator=(VAO&& other) noexcept;
+	VAO(const VAO&) = delete;
+	VAO& operator=(const VAO&) = delete;
+	~VAO();
 
-	// Links a VBO Attribute such as a position or color to the VAO
-	void LinkAttrib(VBO& VBO, GLuint layout, GLuint numComponents, GLenum type, GLsizeiptr stride, void* offset);
+	// Links a VBO Attribute such as a position or color to the VAO.
+	// normalized maps integer data to [0, 1] (or [-1, 1] when signed), as packed normals need;
+	// integer keeps integer data as ints for ivec/uvec shader inputs (glVertexAttribIPointer)
+	void LinkAttrib(VBO& VBO, GLuint layout, GLuint numComponents, GLenum type, GLsizeiptr stride, void* offset,
+		GLboolean normalized = GL_FALSE, bool integer = false);
+	// Same, for a buffer given by name (one this VAO does not own, such as an arena's)
+	void LinkAttrib(GLuint buffer, GLuint layout, GLuint numComponents, GLenum type, GLsizeiptr stride, void* offset,
+		GLboolean normalized = GL_FALSE, bool integer = false);
 	// Binds the VAO
 	void Bind();
 	// Unbinds the VAO
 	void Unbind();
-	// Deletes the VAO
+	// Deletes the VAO (safe to call twice)
 	void Delete();
 };
 
@@ -8,6 +8,13 @@ VBO::VBO(GLfloat* vertices, GLsizeiptr size)
 	glBufferData(GL_ARRAY_BUFFER, size, vertices, GL_DYNAMIC_DRAW);
 }
 
+VBO::VBO(const void* data, GLsizeiptr size, GLenum usage)
+{
+	glGenBuffers(1, &ID);
+	glBindBuffer(GL_ARRAY_BUFFER, ID);
+	glBufferData(GL_ARRAY_BUFFER, size, data, usage);
+}
+
 // Binds the VBO
 void VBO::Bind()
 {
@@ -20,8 +27,33 @@ void VBO::Unbind()
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
 }
 
+// Takes over the other's VBO, leaving it empty
+VBO::VBO(VBO&& other) noexcept
+	: ID(other.ID)
+{
+	other.ID = 0;
+}
+
+VBO& VBO::operator=(VBO&& other) noexcept
+{
+	if (this != &other)
+	{
+		Delete();
+		ID = other.ID;
+		other.ID = 0;
+	}
+	return *this;
+}
+
+VBO::~VBO()
+{
+	Delete();
+}
+
 // Deletes the VBO
 void VBO::Delete()
 {
+	if (ID == 0) return;
 	glDeleteBuffers(1, &ID);
+	ID = 0;
 }
\ No newline at end of file
@@ -7,15 +7,23 @@ class VBO
 {
 public:
 	// Reference ID of the Vertex Buffer Object
-	GLuint ID;
+	GLuint ID = 0;
 	// Constructor that generates a Vertex Buffer Object and links it to vertices
 	VBO(GLfloat* vertices, GLsizeiptr size);
+	// Same for any vertex data (packed formats), with a usage hint such as GL_STATIC_DRAW
+	VBO(const void* data, GLsizeiptr size, GLenum usage);
+	// Owns its buffer: move-only, and deleted with the VBO unless Delete() came first
+	VBO(VBO&& other) noexcept;
+	VBO& operator=(VBO&& other) noexcept;
+	VBO(const VBO&) = delete;
+	VBO& operator=(const VBO&) = delete;
+	~VBO();
 
 	// Binds the VBO
 	void Bind();
 	// Unbinds the VBO
 	void Unbind();
-	// Deletes the VBO
+	// Deletes the VBO (safe to call twice)
 	void Delete();
 };
 